@@ -50,11 +50,177 @@
 
 #include <iostream>
 
+// C++20 coroutines give FlexLexer::tokens() and FlexLexer::tokens_async().
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+# if __has_include(<coroutine>)
+#  define YY_FLEX_COROUTINES 1
+#  include <coroutine>
+#  include <cstddef>
+#  include <exception>
+#  include <iterator>
+#  include <utility>
+# endif
+#endif
+
+// What LexerInput() returns when it has no input for the scanner yet,
+// but may have some later.  yylex() then returns 0, and input_pending()
+// is true until the next call.
+#define YY_INPUT_PENDING (-2)
+
 extern "C++" {
 
 struct yy_buffer_state;
 typedef int yy_state_type;
 
+#ifdef YY_FLEX_COROUTINES
+// The tokens FlexLexer::tokens() returns, found one at a time as the
+// range is iterated over.
+class FlexTokenGenerator
+{
+public:
+  struct promise_type
+  {
+    int token;
+    std::exception_ptr error;
+
+    FlexTokenGenerator get_return_object()
+      { return FlexTokenGenerator( handle::from_promise( *this ) ); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept   { return {}; }
+    std::suspend_always yield_value( int t ) noexcept
+      { token = t; return {}; }
+    void return_void() noexcept { }
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+  typedef std::coroutine_handle<promise_type> handle;
+
+  class iterator
+  {
+  public:
+    typedef std::ptrdiff_t difference_type;
+    typedef int value_type;
+
+    iterator() : h() { }
+    explicit iterator( handle gen ) : h( gen ) { }
+
+    int operator*() const     { return h.promise().token; }
+    iterator& operator++()    { FlexTokenGenerator::step( h ); return *this; }
+    void operator++( int )    { ++*this; }
+    bool operator==( std::default_sentinel_t ) const { return h.done(); }
+
+  private:
+    handle h;
+  };
+
+  FlexTokenGenerator( FlexTokenGenerator&& other ) noexcept : h( other.h )
+    { other.h = nullptr; }
+  FlexTokenGenerator& operator=( FlexTokenGenerator&& other ) noexcept
+  {
+    if ( this != &other ) {
+      if ( h )
+        h.destroy();
+      h = other.h;
+      other.h = nullptr;
+    }
+    return *this;
+  }
+  ~FlexTokenGenerator()       { if ( h ) h.destroy(); }
+
+  // May only be called once.
+  iterator begin()            { step( h ); return iterator( h ); }
+  std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+  explicit FlexTokenGenerator( handle gen ) : h( gen ) { }
+
+  // Run the scanner to its next token, passing on what it threw.
+  static void step( handle gen )
+  {
+    gen.resume();
+    if ( gen.promise().error )
+      std::rethrow_exception( std::exchange( gen.promise().error, nullptr ) );
+  }
+
+  handle h;
+};
+
+// The tokens FlexLexer::tokens_async() returns.  A coroutine gets each
+// in turn with "co_await tokens.next()", which gives 0 at the end of
+// the input.  The scanner runs in whichever thread resumes it: the one
+// awaiting next(), or the one that completes the input it awaits.
+class FlexAsyncTokens
+{
+public:
+  struct promise_type
+  {
+    int token = 0;
+    std::exception_ptr error;
+    std::coroutine_handle<> waiter;   // the coroutine in next()
+
+    // Hands control to the waiter at each token and at the end.
+    struct resume_waiter
+    {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<>
+      await_suspend( std::coroutine_handle<promise_type> gen ) noexcept
+        { return gen.promise().waiter; }
+      void await_resume() noexcept { }
+    };
+
+    FlexAsyncTokens get_return_object()
+      { return FlexAsyncTokens( handle::from_promise( *this ) ); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    resume_waiter final_suspend() noexcept        { return {}; }
+    resume_waiter yield_value( int t ) noexcept
+      { token = t; return {}; }
+    void return_void() noexcept { token = 0; }
+    void unhandled_exception()
+      { error = std::current_exception(); token = 0; }
+  };
+  typedef std::coroutine_handle<promise_type> handle;
+
+  class next_awaiter
+  {
+  public:
+    explicit next_awaiter( handle gen ) : h( gen ) { }
+
+    bool await_ready() const noexcept { return h.done(); }
+    std::coroutine_handle<> await_suspend( std::coroutine_handle<> c ) noexcept
+      { h.promise().waiter = c; return h; }
+    int await_resume()
+    {
+      if ( h.promise().error )
+        std::rethrow_exception( std::exchange( h.promise().error, nullptr ) );
+      return h.done() ? 0 : h.promise().token;
+    }
+
+  private:
+    handle h;
+  };
+
+  FlexAsyncTokens( FlexAsyncTokens&& other ) noexcept : h( other.h )
+    { other.h = nullptr; }
+  FlexAsyncTokens& operator=( FlexAsyncTokens&& other ) noexcept
+  {
+    if ( this != &other ) {
+      if ( h )
+        h.destroy();
+      h = other.h;
+      other.h = nullptr;
+    }
+    return *this;
+  }
+  ~FlexAsyncTokens()          { if ( h ) h.destroy(); }
+
+  next_awaiter next()         { return next_awaiter( h ); }
+
+private:
+  explicit FlexAsyncTokens( handle gen ) : h( gen ) { }
+
+  handle h;
+};
+#endif
+
 class FlexLexer
 {
 public:
@@ -95,6 +261,40 @@ public:
 
   int lineno() const          { return yylineno; }
 
+  // Whether the last yylex() returned 0 because LexerInput() returned
+  // YY_INPUT_PENDING, rather than at the end of the input.
+  virtual bool input_pending() const  { return false; }
+
+#ifdef YY_FLEX_COROUTINES
+  // The tokens yylex() returns, up to the 0 at the end of the input:
+  //
+  //      for ( int tok : lexer.tokens() ) ...
+  FlexTokenGenerator tokens()
+  {
+    for ( int t; ( t = yylex() ) != 0; )
+      co_yield t;
+  }
+
+  // The same, except that when LexerInput() returns YY_INPUT_PENDING
+  // the scanner awaits fill(), which should make more input (or the
+  // end of it) available to LexerInput(), rather than stopping.  The
+  // token that ran into the end of the input so far is scanned again.
+  template <class Fill>
+  FlexAsyncTokens tokens_async( Fill fill )
+  {
+    for ( ;; ) {
+      int t = yylex();
+
+      if ( t != 0 )
+        co_yield t;
+      else if ( input_pending() )
+        co_await fill();
+      else
+        co_return;
+    }
+  }
+#endif
+
   int debug() const           { return yyflexdebug; }
   void set_debug( int flag )  { yyflexdebug = flag; }
 
@@ -145,6 +345,8 @@ public:
   virtual void switch_streams( std::istream* new_in = 0, std::ostream* new_out = 0 );
   virtual int yywrap();
 
+  virtual bool input_pending() const  { return yy_input_pending; }
+
 protected:
   virtual int LexerInput( char* buf, int max_size );
   virtual void LexerOutput( const char* buf, int size );
@@ -168,6 +370,7 @@ protected:
   yy_state_type yy_get_previous_state();
   yy_state_type yy_try_NUL_trans( yy_state_type current_state );
   int yy_get_next_buffer();
+  void yy_state_buf_grow();
 
   std::istream yyin;  // input source for default LexerInput
   std::ostream yyout; // output sink for default LexerOutput
@@ -188,6 +391,8 @@ protected:
   // instead of setting up a fresh yyin.  A bit of a hack ...
   int yy_did_buffer_switch_on_eof;
 
+  // Whether LexerInput() returned YY_INPUT_PENDING in the last yylex().
+  bool yy_input_pending;
 
   size_t yy_buffer_stack_top; /**< index of top of stack. */
   size_t yy_buffer_stack_max; /**< capacity of stack. */
@@ -0,0 +1,477 @@
+/* cache.c - reuse scanners generated before from the same input */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+#include "flexdef.h"
+#include "version.h"
+#include <sys/stat.h>
+
+/* With --cache-dir, everything a scanner is made from -- the version
+ * of flex and its built-in skeletons, the command line, any skeleton
+ * file, and the names and contents of the input files -- is hashed with
+ * SHA-256, and the files flex writes are kept in the cache directory
+ * under that digest.  A later run made from the same things writes those
+ * files again, repeats what it wrote on stderr, and exits, without reading
+ * the rules, building the DFA or running m4.
+ *
+ * An entry is
+ *
+ *	flex-cache 3
+ *	key SIZE
+ *	<SIZE bytes: everything hashed except the file contents, and the digest>
+ *	stderr SIZE
+ *	<SIZE bytes of warnings>
+ *	file SIZE NAME
+ *	<SIZE bytes of the file NAME>
+ *	...
+ *
+ * A hit needs the command line and file names to match byte for byte,
+ * and the contents to have the same SHA-256 digest.  A missing,
+ * unreadable or damaged entry is just a miss; failing to store one is
+ * not an error either.
+ */
+
+#define CACHE_MAGIC "flex-cache 3\n"
+
+/* SHA-256, as in FIPS 180-4. */
+struct sha256 {
+	flex_uint32_t h[8];
+	flex_uint32_t len_lo, len_hi;	/* bytes added so far */
+	unsigned char block[64];
+	size_t  used;			/* bytes of block filled */
+};
+
+static const flex_uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+	0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+	0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+	0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+	0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_init (struct sha256 *c)
+{
+	static const flex_uint32_t h0[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+
+	memcpy (c->h, h0, sizeof (h0));
+	c->len_lo = c->len_hi = 0;
+	c->used = 0;
+}
+
+static void sha256_block (struct sha256 *c)
+{
+	flex_uint32_t w[64], v[8], t1, t2;
+	int     i;
+
+	for (i = 0; i < 16; ++i)
+		w[i] = (flex_uint32_t) c->block[4 * i] << 24
+			| (flex_uint32_t) c->block[4 * i + 1] << 16
+			| (flex_uint32_t) c->block[4 * i + 2] << 8
+			| (flex_uint32_t) c->block[4 * i + 3];
+	for (i = 16; i < 64; ++i)
+		w[i] = (ROTR (w[i - 2], 17) ^ ROTR (w[i - 2], 19) ^ (w[i - 2] >> 10))
+			+ w[i - 7]
+			+ (ROTR (w[i - 15], 7) ^ ROTR (w[i - 15], 18) ^ (w[i - 15] >> 3))
+			+ w[i - 16];
+
+	memcpy (v, c->h, sizeof (v));
+	for (i = 0; i < 64; ++i) {
+		t1 = v[7] + (ROTR (v[4], 6) ^ ROTR (v[4], 11) ^ ROTR (v[4], 25))
+			+ ((v[4] & v[5]) ^ (~v[4] & v[6])) + sha256_k[i] + w[i];
+		t2 = (ROTR (v[0], 2) ^ ROTR (v[0], 13) ^ ROTR (v[0], 22))
+			+ ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+		memmove (v + 1, v, 7 * sizeof (v[0]));
+		v[4] += t1;
+		v[0] = t1 + t2;
+	}
+	for (i = 0; i < 8; ++i)
+		c->h[i] += v[i];
+}
+
+static void sha256_add (struct sha256 *c, const void *data, size_t n)
+{
+	const unsigned char *p = data;
+	size_t  take;
+
+	c->len_lo += (flex_uint32_t) n;
+	if (c->len_lo < (flex_uint32_t) n)
+		++c->len_hi;
+	c->len_hi += (flex_uint32_t) ((n >> 16) >> 16);
+
+	while (n > 0) {
+		take = 64 - c->used < n ? 64 - c->used : n;
+		memcpy (c->block + c->used, p, take);
+		c->used += take;
+		p += take;
+		n -= take;
+		if (c->used == 64) {
+			sha256_block (c);
+			c->used = 0;
+		}
+	}
+}
+
+/* Finishes the digest, and writes it to hex as 64 digits and a NUL. */
+static void sha256_hex (struct sha256 *c, char *hex)
+{
+	flex_uint32_t hi = c->len_hi << 3 | c->len_lo >> 29, lo = c->len_lo << 3;
+	unsigned char pad = 0x80;
+	int     i;
+
+	sha256_add (c, &pad, 1);
+	pad = 0;
+	while (c->used != 56)
+		sha256_add (c, &pad, 1);
+	for (i = 0; i < 4; ++i)
+		c->block[56 + i] = (unsigned char) (hi >> (24 - 8 * i));
+	for (i = 0; i < 4; ++i)
+		c->block[60 + i] = (unsigned char) (lo >> (24 - 8 * i));
+	sha256_block (c);
+
+	for (i = 0; i < 8; ++i)
+		snprintf (hex + 8 * i, 9, "%08lx", (unsigned long) c->h[i]);
+}
+
+static struct sha256 key_hash;
+static struct Buf key_text;
+static bool have_key = false;
+static char cache_path[MAXLINE];
+
+/* On a miss, stderr goes to err_copy until cache_finish(); err_fd is
+ * where it went before.
+ */
+static FILE *err_copy = NULL;
+static int err_fd = -1;
+
+static void key_add (const void *data, size_t n)
+{
+	sha256_add (&key_hash, data, n);
+}
+
+/* Adds a string to the key, keeping a copy to check on a hit. */
+static void key_str (const char *s)
+{
+	key_add (s, strlen (s) + 1);
+	buf_strappend (&key_text, s);
+	buf_strappend (&key_text, "\n");
+}
+
+/* Adds a file's contents to the key.  Returns false if it can't be read;
+ * flex will then complain about it in the usual way.
+ */
+static bool key_file (const char *name)
+{
+	char    chunk[BUFSIZ], size[32];
+	size_t  n, total = 0;
+	FILE   *f;
+
+	if ((f = fopen (name, "rb")) == NULL)
+		return false;
+	while ((n = fread (chunk, 1, sizeof (chunk), f)) > 0) {
+		key_add (chunk, n);
+		total += n;
+	}
+	if (ferror (f)) {
+		fclose (f);
+		return false;
+	}
+	fclose (f);
+	snprintf (size, sizeof (size), "%lu", (unsigned long) total);
+	key_str (size);
+	return true;
+}
+
+static void key_skel_line (const char *line, void *arg)
+{
+	(void) arg;
+	key_add (line, strlen (line) + 1);
+}
+
+/* Reads the rest of a stream into memory.  Returns NULL if it can't. */
+static char *slurp_stream (FILE *f, size_t *len)
+{
+	char   *data = NULL, *grown;
+	size_t  max = 0, n;
+
+	*len = 0;
+	do {
+		if (*len == max) {
+			max = max ? 2 * max : BUFSIZ;
+			if ((grown = realloc (data, max)) == NULL) {
+				free (data);
+				*len = 0;
+				return NULL;
+			}
+			data = grown;
+		}
+		n = fread (data + *len, 1, max - *len, f);
+		*len += n;
+	} while (n > 0);
+	if (ferror (f)) {
+		free (data);
+		data = NULL;
+		*len = 0;
+	}
+	return data;
+}
+
+/* Reads a whole file into memory.  Returns NULL if it can't. */
+static char *slurp (const char *name, size_t *len)
+{
+	char   *data;
+	FILE   *f;
+
+	*len = 0;
+	if ((f = fopen (name, "rb")) == NULL)
+		return NULL;
+	data = slurp_stream (f, len);
+	fclose (f);
+	return data;
+}
+
+/* Reads one "WORD SIZE[ NAME]\n" record header at *p, leaving *p at
+ * the record's contents and the name, if asked for, in name.  Returns
+ * false if it isn't one.
+ */
+static bool parse_record (char **p, const char *end, const char *word,
+			  size_t *size, char *name, size_t name_max)
+{
+	size_t  wlen = strlen (word);
+	char   *nl, *q;
+
+	if ((nl = memchr (*p, '\n', (size_t) (end - *p))) == NULL
+	    || (size_t) (nl - *p) <= wlen + 1
+	    || strncmp (*p, word, wlen) != 0 || (*p)[wlen] != ' '
+	    || !isdigit ((unsigned char) (*p)[wlen + 1]))
+		return false;
+	*size = (size_t) strtoul (*p + wlen + 1, &q, 10);
+	if (name != NULL) {
+		if (*q != ' ' || q + 1 == nl || (size_t) (nl - q) > name_max)
+			return false;
+		memcpy (name, q + 1, (size_t) (nl - q - 1));
+		name[nl - q - 1] = '\0';
+	}
+	else if (q != nl)
+		return false;
+	*p = nl + 1;
+	return *size <= (size_t) (end - *p);
+}
+
+/* Writes out the files of a cache entry if it is one for this key.
+ * Returns false, having written nothing, if it isn't.
+ */
+static bool replay (char *data, size_t len)
+{
+	char   *p, *contents, *warnings, *end = data + len, name[MAXLINE];
+	size_t  size, warnings_size;
+	FILE   *f;
+
+	if (len < strlen (CACHE_MAGIC)
+	    || strncmp (data, CACHE_MAGIC, strlen (CACHE_MAGIC)) != 0)
+		return false;
+	p = data + strlen (CACHE_MAGIC);
+	if (!parse_record (&p, end, "key", &size, NULL, 0)
+	    || size != (size_t) key_text.nelts
+	    || memcmp (p, key_text.elts, size) != 0)
+		return false;
+	p += size;
+	if (!parse_record (&p, end, "stderr", &warnings_size, NULL, 0))
+		return false;
+	warnings = p;
+	contents = p += warnings_size;
+
+	/* Check the whole entry before writing any of it. */
+	while (p < end) {
+		if (!parse_record (&p, end, "file", &size, name, sizeof (name)))
+			return false;
+		p += size;
+	}
+
+	for (p = contents; p < end; p += size) {
+		parse_record (&p, end, "file", &size, name, sizeof (name));
+		if ((f = fopen (name, "wb")) == NULL)
+			lerr (_("could not create %s"), name);
+		if (fwrite (p, 1, size, f) != size || fclose (f) != 0)
+			lerr (_("error writing output file %s"), name);
+	}
+	fwrite (warnings, 1, warnings_size, stderr);
+	return true;
+}
+
+/* Sends stderr to a temporary file, to be kept with the entry.  Returns
+ * false, leaving stderr alone, if it can't.
+ */
+static bool capture_stderr (void)
+{
+	fflush (stderr);
+	if ((err_copy = tmpfile ()) == NULL)
+		return false;
+	if ((err_fd = dup (fileno (stderr))) == -1
+	    || dup2 (fileno (err_copy), fileno (stderr)) == -1) {
+		if (err_fd != -1)
+			close (err_fd);
+		err_fd = -1;
+		fclose (err_copy);
+		err_copy = NULL;
+		return false;
+	}
+	return true;
+}
+
+/* cache_lookup - look for the scanner this run would generate
+ *
+ * Called once the command line has been read.  On a hit, writes the
+ * scanner's files and exits; otherwise returns, remembering the key so
+ * that cache_store() can keep what this run generates.
+ */
+void cache_lookup (char **argv, int first_input)
+{
+	char   *data, digest[65];
+	size_t  len;
+	int     i;
+
+	if (env.use_stdout || num_input_files == 0
+	    || env.printstats || env.trace || env.performance_hint > 0)
+		return;
+
+	sha256_init (&key_hash);
+	buf_init (&key_text, sizeof (char));
+
+	key_str (FLEX_VERSION);
+	skel_walk (key_skel_line, NULL);
+	for (i = 1; i < first_input; ++i)
+		key_str (argv[i]);
+	if (getenv ("POSIXLY_CORRECT"))
+		key_str ("POSIXLY_CORRECT");
+	if (env.skelname && !key_file (env.skelname))
+		return;
+	for (i = 0; i < num_input_files; ++i) {
+		key_str (input_files[i]);
+		if (!key_file (input_files[i]))
+			return;
+	}
+
+	/* The digest goes in the entry too, so a hit checks the contents. */
+	sha256_hex (&key_hash, digest);
+	buf_strappend (&key_text, "sha256 ");
+	buf_strappend (&key_text, digest);
+	buf_strappend (&key_text, "\n");
+	snprintf (cache_path, sizeof (cache_path), "%s/%s", env.cache_dir,
+		  digest);
+
+	if ((data = slurp (cache_path, &len)) != NULL) {
+		if (replay (data, len)) {
+			free (data);
+			FLEX_EXIT (0);
+		}
+		free (data);
+	}
+
+	/* Without its warnings, an entry would hide them on a hit. */
+	have_key = capture_stderr ();
+}
+
+/* cache_store - keep the files this run generated
+ *
+ * Written to a temporary name first, so a concurrent run never sees
+ * half an entry.
+ */
+void cache_store (const char **files, int nfiles)
+{
+	char    tmp_path[MAXLINE + 32];
+	char   *data;
+	size_t  len;
+	bool    ok;
+	int     i;
+	FILE   *f;
+
+	if (!have_key)
+		return;
+	have_key = false;
+
+	mkdir (env.cache_dir, 0777);
+	snprintf (tmp_path, sizeof (tmp_path), "%s.%ld", cache_path,
+		  (long) getpid ());
+	if ((f = fopen (tmp_path, "wb")) == NULL)
+		return;
+
+	fputs (CACHE_MAGIC, f);
+	fprintf (f, "key %d\n", key_text.nelts);
+	fwrite (key_text.elts, 1, (size_t) key_text.nelts, f);
+
+	fflush (stderr);
+	rewind (err_copy);
+	ok = (data = slurp_stream (err_copy, &len)) != NULL;
+	if (ok) {
+		fprintf (f, "stderr %lu\n", (unsigned long) len);
+		ok = fwrite (data, 1, len, f) == len;
+		free (data);
+	}
+
+	for (i = 0; ok && i < nfiles; ++i) {
+		if ((data = slurp (files[i], &len)) == NULL) {
+			ok = false;
+			break;
+		}
+		fprintf (f, "file %lu %s\n", (unsigned long) len, files[i]);
+		ok = fwrite (data, 1, len, f) == len;
+		free (data);
+	}
+
+	if (fclose (f) != 0 || !ok || rename (tmp_path, cache_path) != 0)
+		unlink (tmp_path);
+}
+
+/* cache_finish - give stderr back, with what was written on it meanwhile
+ *
+ * Called as flex exits, after cache_store() if the run succeeded.
+ */
+void cache_finish (void)
+{
+	char    chunk[BUFSIZ];
+	size_t  n;
+
+	if (err_copy == NULL)
+		return;
+
+	fflush (stderr);
+	dup2 (err_fd, fileno (stderr));
+	close (err_fd);
+	err_fd = -1;
+
+	rewind (err_copy);
+	while ((n = fread (chunk, 1, sizeof (chunk), err_copy)) > 0)
+		fwrite (chunk, 1, n, stderr);
+	fclose (err_copy);
+	err_copy = NULL;
+}
@@ -339,6 +339,36 @@ ADD_STATE(state); \
 }
 
 
+/* is_hot_state - whether -Ch gives a DFA state a dense row
+ *
+ * synopsis
+ *    bool is_hot_state( int ds, int state[numecs], int totaltrans );
+ *
+ * Every token starts in a start state, and long tokens spend their
+ * time in states with a transition back to themselves; those are the
+ * states whose lookups should not go through yy_def.  Once the rows
+ * would take more than HYBRID_MAX_ENTRIES entries, no more are given.
+ */
+
+static bool is_hot_state (int ds, int state[], int totaltrans)
+{
+	int     i;
+
+	if (totaltrans == 0 || ds == end_of_buffer_state ||
+	    (num_dense_rows + 2) * (numecs + 1) > HYBRID_MAX_ENTRIES)
+		return false;
+
+	if (ds <= lastsc * 2)
+		return true;
+
+	for (i = 1; i <= numecs; ++i)
+		if (state[i] == ds)
+			return true;
+
+	return false;
+}
+
+
 /* increase_max_dfas - increase the maximum number of DFAs */
 
 void increase_max_dfas (void)
@@ -359,6 +389,16 @@ void increase_max_dfas (void)
 		nultrans =
 			reallocate_integer_array (nultrans,
 						  current_max_dfas);
+
+	if (dfa_nxt)
+		dfa_nxt =
+			reallocate_integer_array (dfa_nxt,
+						  current_max_dfas * (numecs + 1));
+
+	if (dense_row)
+		dense_row =
+			reallocate_integer_array (dense_row,
+						  current_max_dfas);
 }
 
 
@@ -462,6 +502,13 @@ size_t ntod (void)
 	if (ctrl.fulltbl && ecgroup[0] == numecs && is_power_of_2(numecs))
 		nultrans = allocate_integer_array (current_max_dfas);
 
+	if (ctrl.shuffle_dfa || ctrl.stride > 1 || ctrl.hybrid
+	    || num_chunked_rules > 0)
+		dfa_nxt = allocate_integer_array (current_max_dfas * (numecs + 1));
+
+	if (ctrl.hybrid)
+		dense_row = allocate_integer_array (current_max_dfas);
+
 	if (ctrl.fullspd) {
 		for (i = 0; i <= numecs; ++i)
 			state[i] = 0;
@@ -657,11 +704,18 @@ size_t ntod (void)
 		if (ds > num_start_states)
 			check_for_backing_up (ds, state);
 
+		if (dfa_nxt)
+			for (i = 1; i <= numecs; ++i)
+				dfa_nxt[ds * (numecs + 1) + i] = state[i];
+
 		if (nultrans) {
 			nultrans[ds] = state[NUL_ec];
 			state[NUL_ec] = 0;	/* remove transition */
 		}
 
+		if (dense_row)
+			dense_row[ds] = 0;
+
 		if (ctrl.fulltbl) {
 
 			/* Each time we hit here, it's another td_hilen, so we realloc. */
@@ -709,6 +763,15 @@ size_t ntod (void)
 			 */
 			stack1 (ds, 0, 0, JAMSTATE);
 
+		else if (ctrl.hybrid && is_hot_state (ds, state, totaltrans)) {
+			/* Kept out of the compressed tables; gentabs() tags
+			 * its base with where its row is.
+			 */
+			dense_row[ds] = ++num_dense_rows;
+			base[ds] = 0;
+			def[ds] = JAMSTATE;
+		}
+
 		else {		/* normal, compressed state */
 
 			/* Determine which destination state is the most
@@ -878,10 +941,16 @@ int snstods (int sns[], int numstates, int accset[], int nacc, int hashval, int
 			if (accset[i] < j)
 				j = accset[i];
 
-		dfaacc[newds].dfaacc_state = j;
-
+		/* A state holding nothing but the ends of trailing context
+		 * heads accepts nothing; with trail_tags they are only used
+		 * for the position tags.
+		 */
 		if (j <= num_rules)
 			rule_useful[j] = true;
+		else
+			j = 0;
+
+		dfaacc[newds].dfaacc_state = j;
 	}
 
 	*newds_addr = newds;
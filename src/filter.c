@@ -28,6 +28,15 @@ static const char * check_4_gnu_m4 =
     " m4exit(2)')\n";
 
 
+/* The start of m4's input: the quotes flex uses, and a macro for
+ * breaking them up in user code.
+ */
+#define M4_PROLOGUE \
+	"m4_changecom`'m4_dnl\n" \
+	"m4_changequote`'m4_dnl\n" \
+	"m4_changequote([[,]])[[]]m4_dnl\n" \
+	"m4_define([[M4_YY_NOOP]])[[]]m4_dnl\n"
+
 /** global chain. */
 struct filter *output_chain = NULL;
 
@@ -257,10 +266,7 @@ int filter_tee_header (struct filter *chain)
 
 	if (write_header) {
 		fputs (check_4_gnu_m4, to_h);
-		fputs ("m4_changecom`'m4_dnl\n", to_h);
-		fputs ("m4_changequote`'m4_dnl\n", to_h);
-	fputs ("m4_changequote([[,]])[[]]m4_dnl\n", to_h);
-		fputs ("m4_define([[M4_YY_NOOP]])[[]]m4_dnl\n", to_h);
+		fputs (M4_PROLOGUE, to_h);
 		fputs ("m4_define([[M4_YY_IN_HEADER]],[[]])m4_dnl\n", to_h);
 		fprintf (to_h,
 			 "m4_define( [[M4_YY_OUTFILE_NAME]],[[%s]])m4_dnl\n",
@@ -268,10 +274,7 @@ int filter_tee_header (struct filter *chain)
 	}
 
 	fputs (check_4_gnu_m4, to_c);
-	fputs ("m4_changecom`'m4_dnl\n", to_c);
-	fputs ("m4_changequote`'m4_dnl\n", to_c);
-	fputs ("m4_changequote([[,]])[[]]m4_dnl\n", to_c);
-	fputs ("m4_define([[M4_YY_NOOP]])[[]]m4_dnl\n", to_c);
+	fputs (M4_PROLOGUE, to_c);
 	fprintf (to_c, "m4_define( [[M4_YY_OUTFILE_NAME]],[[%s]])m4_dnl\n",
 		 env.outfilename != NULL ? env.outfilename : "<stdout>");
 
@@ -319,25 +322,47 @@ static bool is_blank_line (const char *str)
 	return (*str == '\0');
 }
 
+/* Reads lines for fix_linedirs() from stdin... */
+static char *file_gets (char *buf, int size, void *from)
+{
+	return fgets (buf, size, (FILE *) from);
+}
+
+/* ...or from memory, just as fgets() would. */
+struct text_lines {
+	const char *p, *end;
+};
+
+static char *text_gets (char *buf, int size, void *from)
+{
+	struct text_lines *t = from;
+	int     n = 0;
+
+	if (t->p == t->end)
+		return NULL;
+	while (n < size - 1 && t->p != t->end)
+		if ((buf[n++] = *t->p++) == '\n')
+			break;
+	buf[n] = '\0';
+	return buf;
+}
+
 /** Adjust the line numbers in the #line directives of the generated scanner.
  * After the m4 expansion, the line numbers are incorrect since the m4 macros
  * can add or remove lines.  This only adjusts line numbers for generated code,
  * not user code. This also happens to be a good place to squeeze multiple
  * blank lines into a single blank line.
  */
-int filter_fix_linedirs (struct filter *chain)
+static void fix_linedirs (char *(*get_line) (char *, int, void *),
+			  void *from, FILE *to)
 {
 	char   buf[4096];
-	const char *traceline_template, *cp;
 	const size_t readsz = sizeof buf;
 	int     lineno = 1;
 	bool    in_gen = true;	/* in generated code */
 	bool    last_was_blank = false;
 
-	if (!chain)
-		return 0;
-
-	while (fgets (buf, (int) readsz, stdin)) {
+	while (get_line (buf, (int) readsz, from)) {
 
 		regmatch_t m[10];
 
@@ -381,7 +406,7 @@ int filter_fix_linedirs (struct filter *chain)
 
 				/* Adjust the line directives. */
 				in_gen = true;
-				snprintf (buf, readsz, traceline_template,
+				snprintf (buf, readsz, ctrl.traceline_template,
 					  lineno + 1, filename);
 				strncat(buf, "\n", sizeof(buf)-1);
 			}
@@ -407,9 +432,17 @@ int filter_fix_linedirs (struct filter *chain)
 			last_was_blank = false;
 		}
 
-		fputs (buf, stdout);
+		fputs (buf, to);
 		lineno++;
 	}
+}
+
+int filter_fix_linedirs (struct filter *chain)
+{
+	if (!chain)
+		return 0;
+
+	fix_linedirs (file_gets, stdin, stdout);
 	fflush (stdout);
 	if (ferror (stdout))
 		lerr (_("error writing output file %s"),
@@ -422,4 +455,112 @@ int filter_fix_linedirs (struct filter *chain)
 	return 0;
 }
 
+/* Without an m4 to run, flex expands its output itself.  The scanner
+ * is written to a temporary file rather than down the chain; once it is
+ * complete, it is read back, expanded by m4_expand() and has its #line
+ * directives fixed in memory, once for the C file and once for the
+ * header.
+ */
+static int expand_stdout = -1;	/* where stdout really goes */
+static FILE *expand_tmp = NULL;
+static const char *expand_header = NULL;
+
+/* filter_expand_begin - collect the output for filter_expand_end() */
+void filter_expand_begin (const char *headerfilename)
+{
+	fflush (stdout);
+	if ((expand_tmp = tmpfile ()) == NULL)
+		flexfatal (_("tmpfile() failed"));
+	if ((expand_stdout = dup (1)) == -1)
+		flexfatal (_("dup(1) failed"));
+	if (dup2 (fileno (expand_tmp), 1) == -1)
+		flexfatal (_("dup2(tmpfile,1)"));
+	fseek (stdout, 0, SEEK_CUR);
+	expand_header = headerfilename;
+}
+
+/* Expands a prologue and text, and writes the result to a file. */
+static void expand_to (const char *prologue, const char *text, size_t len,
+		       FILE *to)
+{
+	struct text_lines lines;
+	size_t  plen = strlen (prologue), outlen;
+	char   *in, *out;
+
+	if ((in = malloc (plen + len)) == NULL)
+		flexfatal (_("memory allocation failed in filter_expand_end()"));
+	memcpy (in, prologue, plen);
+	memcpy (in + plen, text, len);
+	out = m4_expand (in, plen + len, &outlen);
+	free (in);
+
+	lines.p = out;
+	lines.end = out + outlen;
+	fix_linedirs (text_gets, &lines, to);
+	free (out);
+}
+
+/* filter_expand_end - expand the collected output and write it out */
+void filter_expand_end (void)
+{
+	char    prologue[3 * MAXLINE], *raw;
+	size_t  c_len, len, n;
+	FILE   *to_h;
+
+	if (expand_tmp == NULL)
+		return;
+
+	/* The header gets a fake line number after the scanner, for
+	 * fix_linedirs() to correct.
+	 */
+	fflush (stdout);
+	c_len = (size_t) ftell (stdout);
+	if (expand_header) {
+		fprintf (stdout, "\n");
+		if (ctrl.gen_line_dirs)
+			line_directive_out (stdout, NULL, 4000);
+		fflush (stdout);
+	}
+	len = (size_t) ftell (stdout);
+	if (ferror (stdout) || (raw = malloc (len)) == NULL)
+		flexfatal (_("could not read back the scanner"));
+	rewind (expand_tmp);
+	for (n = 0; n < len; n += fread (raw + n, 1, len - n, expand_tmp))
+		if (feof (expand_tmp) || ferror (expand_tmp))
+			flexfatal (_("could not read back the scanner"));
+	fclose (expand_tmp);
+	expand_tmp = NULL;
+
+	if (dup2 (expand_stdout, 1) == -1)
+		flexfatal (_("dup2(expand_stdout,1)"));
+	close (expand_stdout);
+	fseek (stdout, 0, SEEK_CUR);
+
+	if (expand_header) {
+		if ((to_h = fopen (expand_header, "w")) == NULL)
+			lerr (_("could not create %s"), expand_header);
+		snprintf (prologue, sizeof (prologue),
+			  M4_PROLOGUE
+			  "m4_define([[M4_YY_IN_HEADER]],[[]])m4_dnl\n"
+			  "m4_define( [[M4_YY_OUTFILE_NAME]],[[%s]])m4_dnl\n",
+			  expand_header);
+		expand_to (prologue, raw, len, to_h);
+		if (ferror (to_h))
+			lerr (_("error writing output file %s"), expand_header);
+		else if (fclose (to_h))
+			lerr (_("error closing output file %s"), expand_header);
+	}
+
+	snprintf (prologue, sizeof (prologue),
+		  M4_PROLOGUE
+		  "m4_define( [[M4_YY_OUTFILE_NAME]],[[%s]])m4_dnl\n",
+		  env.outfilename != NULL ? env.outfilename : "<stdout>");
+	expand_to (prologue, raw, c_len, stdout);
+	free (raw);
+	fflush (stdout);
+	if (ferror (stdout))
+		lerr (_("error writing output file %s"),
+			env.outfilename != NULL ? env.outfilename : "<stdout>");
+}
+
 /* vim:set expandtab cindent tabstop=4 softtabstop=4 shiftwidth=4 textwidth=0: */
@@ -199,6 +199,21 @@
 
 #define JAMSTATE -32766		/* marks a reference to the state that always jams */
 
+/* Largest DFA that --shuffle-dfa can run: one byte lane per state, plus
+ * lane 0 for the jam state, in a 16-byte shuffle.
+ */
+#define SHUFFLE_MAX_STATES 15
+
+/* Largest pair table -Cs2 will generate, in bytes; past this the scanner
+ * steps one byte at a time as usual.
+ */
+#define STRIDE_MAX_BYTES (512 * 1024)
+
+/* Most entries -Ch will give to dense rows; past this, hot states are
+ * compressed like the rest.
+ */
+#define HYBRID_MAX_ENTRIES (32 * 1024)
+
 /* Maximum number of NFA states. */
 #define MAXIMUM_MNS 31999
 #define MAXIMUM_MNS_LONG 1999999999
@@ -310,7 +325,9 @@ struct ctrl_bundle_t {
 	bool bison_bridge_lval;	// (--bison-bridge), bison pure calling convention. 
 	bool bison_bridge_lloc;	// (--bison-locations), bison yylloc.
 	size_t bufsize;		// input buffer size
+	bool bulk_input;	// (--bulk-input) yyinput_bulk(), yyskip() and yypeek()
 	bool C_plus_plus;	// (-+ flag) generate a C++ scanner class 
+	bool catch_backup;	// (--catch-backup) -Cf/-CF match loops keep no backing-up info
 	int csize;		// size of character set for the scanner 
 				// 128 for 7-bit chars and 256 for 8-bit 
 	bool ddebug;		// (-d) make a "debug" scanner 
@@ -319,11 +336,16 @@ struct ctrl_bundle_t {
 	bool do_yylineno;	// if true, generate code to maintain yylineno 
 	bool do_yywrap;		// do yywrap() processing on EOF. 
 				// If false, EOF treated as "no more files" 
+	bool echo_spans;	// (--echo-spans) queue consecutive ECHOs and write them at once
 	bool fullspd;		// (-F flag) use Jacobson method of table representation 
 	bool fulltbl;		// (-Cf flag) don't compress the DFA state table 
  	bool gen_line_dirs;	// (no -L flag) generate #line directives 
 	trit interactive;	// (-I) generate an interactive scanner
+	bool hybrid;		// (-Ch) dense rows for hot states in the compressed tables
+	bool interleave;	// (--interleave) generate yylex_interleaved()
 	bool never_interactive;	// always use buffered input, don't check for tty.
+	bool parallel;		// (--parallel) generate yylex_parallel()
+	bool lazy_dfa;		// (--lazy-dfa) build DFA states at run time
 	bool lex_compat;	// (-l), maximize compatibility with AT&T lex 
 	bool long_align;	// (-Ca flag), favor long-word alignment for speed 
 	bool no_yyinput;	// suppress use of yyinput()
@@ -333,8 +355,14 @@ struct ctrl_bundle_t {
 	char *prefix;		// prefix for externally visible names, default "yy" 
 	trit reject_really_used;// Force generation of support code for reject operation
 	bool reentrant;		// if true (-R), generate a reentrant C scanner
+	bool relex;		// (--relex) generate yy_relex()
 	bool rewrite;		// Appl;y magic rewre rles to special fumctions 
+	bool shared_runtime;	// (--shared-runtime) buffer management from libflexrt
+	bool shuffle_dfa;	// (--shuffle-dfa) byte-shuffle tables for small DFAs
 	bool stack_used;	// Enable use of start-condition stacks
+	int stride;		// (-Cs2) input bytes consumed per DFA step
+	bool thread_local;	// (--thread-local) per-thread state in a non-reentrant scanner
+	bool token_batch;	// (--token-batch) generate yylex_batch()
 	bool no_section3_escape;// True if the undocumented option --unsafe-no-m4-sect3-escape was passed
 	bool spprdflt;		// (-s) suppress the default rule
 	bool useecs;		// (-Ce flag) use equivalence classes 
@@ -379,6 +407,7 @@ struct ctrl_bundle_t {
 	bool no_yyset_lval;
 	bool no_yyget_lloc;
 	bool no_yyset_lloc;
+	bool no_yyset_buffer_policy;
 	bool no_flex_alloc;
 	bool no_flex_realloc;
 	bool no_flex_free;
@@ -399,8 +428,10 @@ struct ctrl_bundle_t {
 struct env_bundle_t {
 	bool backing_up_report;	// (-b flag), generate "lex.backup" file 
 				// listing backing-up states
+	char *cache_dir;	// (--cache-dir) where generated scanners are kept for reuse
 	bool did_outfilename;	// whether outfilename was explicitly set
 	char *headerfilename;	// name of the .h file to generate
+	int jobs;		// (-j N) generate each input file's scanner on its own, N at a time
 	bool nowarn;		// (-w) do not generate warnings 
 	int performance_hint;	// if > 0 (i.e., -p flag), generate a report 
 				// relating to scanner performance; 
@@ -437,6 +468,7 @@ extern struct env_bundle_t env;
  * continued_action - true if this rule's action is to "fall through" to
  *   the next rule's action (i.e., the '|' action)
  * in_rule - true if we're inside an individual rule, false if not.
+ * chunked_rule - true if the rule about to be parsed was marked %chunked
  * yymore_really_used - whether to treat yymore() as really used, regardless
  *   of what we think based on references to it in the user's actions.
  * reject_really_used - same for REJECT
@@ -444,6 +476,7 @@ extern struct env_bundle_t env;
 
 extern int syntaxerror, eofseen;
 extern int yymore_used, reject, real_reject, continued_action, in_rule;
+extern int chunked_rule;
 
 /* Variables used in the flex input routines:
  * datapos - characters on current output line
@@ -521,7 +554,18 @@ extern int onenext[ONE_STACK_SIZE], onedef[ONE_STACK_SIZE], onesp;
  * 	context
  * rule_linenum - line number associated with rule
  * rule_useful - true if we've determined that the rule can be matched
+ * rule_trail - for fixed-size trailing context rules, the length of the
+ * 	matched text if positive, minus the length of the trailing context
+ * 	if negative; zero for all other rules
  * rule_has_nl - true if rule could possibly match a newline
+ * rule_skip - true if rule's action is empty, so the rule can be matched
+ * 	without leaving the scanner's match loop
+ * num_skip_rules - number of rules with rule_skip set
+ * rule_chunked - true if rule was marked %chunked, so a long token it
+ * 	matches can be handed to the program in pieces
+ * num_chunked_rules - number of rules with rule_chunked set
+ * rule_echo - true if rule's action does nothing but ECHO, so with
+ * 	--echo-spans its text can be queued with that of the rules before it
  * ccl_has_nl - true if current ccl could match a newline
  * nlch - default eol char
  * footprint - total size of tables, in bytes.
@@ -531,8 +575,9 @@ extern int maximum_mns, current_mns, current_max_rules;
 extern int num_rules, num_eof_rules, default_rule, lastnfa;
 extern int *firstst, *lastst, *finalst, *transchar, *trans1, *trans2;
 extern int *accptnum, *assoc_rule, *state_type;
-extern int *rule_type, *rule_linenum, *rule_useful;
-extern bool *rule_has_nl, *ccl_has_nl;
+extern int *rule_type, *rule_linenum, *rule_useful, *rule_trail;
+extern bool *rule_has_nl, *rule_skip, *rule_chunked, *rule_echo, *ccl_has_nl;
+extern int num_skip_rules, num_chunked_rules;
 extern int nlch;
 extern size_t footprint;
 
@@ -556,6 +601,12 @@ extern int current_state_type;
  */
 extern int variable_trailing_context_rules;
 
+/* True if the variable trailing context rules are matched by recording
+ * where their heads end in position tags as the scanner goes, rather
+ * than with the REJECT machinery.
+ */
+extern int trail_tags;
+
 
 /* Variables for protos:
  * numtemps - number of templates created
@@ -641,6 +692,11 @@ extern char **scname;
  * jambase - position in base/def where the default jam table starts
  * jamstate - state number corresponding to "jam" state
  * end_of_buffer_state - end-of-buffer dfa state number
+ * dfa_nxt - uncompressed transitions of each dfa state, numecs + 1 per
+ *	state, kept for --shuffle-dfa, -Cs2, -Ch and %chunked
+ * dense_row - for -Ch, the dense row of each dfa state, or 0 if the state
+ *	is in the compressed tables
+ * num_dense_rows - number of dense rows handed out
  */
 
 extern int current_max_dfa_size, current_max_xpairs;
@@ -655,6 +711,7 @@ extern union dfaacc_union {
 extern int *accsiz, *dhash, numas;
 extern int numsnpairs, jambase, jamstate;
 extern int end_of_buffer_state;
+extern int *dfa_nxt, *dense_row, num_dense_rows;
 
 /* Variables for ccl information:
  * lastccl - ccl index of the last created ccl
@@ -753,6 +810,17 @@ void   *reallocate_array(void *, int, size_t);
 /* External functions that are cross-referenced among the flex source files. */
 
 
+/* from file cache.c */
+
+/* Write out the scanner generated before from the same input, if any. */
+extern void cache_lookup(char **, int);
+
+/* Keep the files this run generated for cache_lookup() to find. */
+extern void cache_store(const char **, int);
+
+/* Give back the stderr that cache_lookup() took over on a miss. */
+extern void cache_finish(void);
+
 /* from file ccl.c */
 
 extern void ccladd(int, int);	/* add a single character to a ccl */
@@ -822,6 +890,9 @@ extern void genftbl(void);
 /* Generate data statements for the transition tables. */
 extern void gentabs(void);
 
+/* Write the trailing-context table to the tables file. */
+extern void gentrailfile(void);
+
 /* Write out a formatted string at the current indentation level. */
 extern void indent_put2s(const char *, const char *);
 
@@ -834,6 +905,12 @@ extern void make_tables(void);
 /* Select a type for optimal packing */
 struct packtype_t *optimize_pack(size_t);
 
+/* from file m4.c */
+
+/* Expand the m4 macros in flex's output, as "m4 -P" would. */
+extern char *m4_expand(const char *, size_t, size_t *);
+
+
 /* from file main.c */
 
 extern void check_options(void);
@@ -973,6 +1050,9 @@ extern void dumpnfa(int);
 /* Finish up the processing for a rule. */
 extern void finish_rule(int, int, int, int, int);
 
+/* Finish up the processing for an action. */
+extern void finish_action(void);
+
 /* Connect two machines together. */
 extern int link_machines(int, int);
 
@@ -1054,6 +1134,9 @@ extern void backend_by_name(const char *);
 /* Write out one section of the skeleton file. */
 extern void skelout(bool);
 
+/* Pass each line of each built-in skeleton to a function. */
+extern void skel_walk(void (*)(const char *, void *), void *);
+
 /* from file sym.c */
 
 /* Save the text of a character class. */
@@ -1190,6 +1273,8 @@ extern bool filter_apply_chain(struct filter * chain);
 extern int filter_truncate(struct filter * chain, int max_len);
 extern int filter_tee_header(struct filter *chain);
 extern int filter_fix_linedirs(struct filter *chain);
+extern void filter_expand_begin(const char *headerfilename);
+extern void filter_expand_end(void);
 
 
 /*
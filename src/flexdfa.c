@@ -0,0 +1,370 @@
+/* flexdfa - flex run-time support library: matching with loaded tables */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+/* The matching loops of the C skeleton, for compressed and -Cf tables,
+ * run over tables read from a serialized set rather than compiled in.
+ * Keep them in step with cpp-flex.skl and gen.c.  The text is a plain
+ * byte range, so there is no end-of-buffer character: running out of
+ * text ends the match as a jam would.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flexint.h"
+#include "tables_shared.h"
+#include "libflex.h"
+
+struct flex_tbl
+	{
+	flex_int32_t *data;
+	flex_int32_t len;
+	};
+
+struct flex_dfa
+	{
+	int rules;		/* YY_END_OF_BUFFER - 2 */
+	int start_conditions;
+	flex_int32_t jamstate;
+	flex_int32_t jambase;
+	flex_int32_t nul_ec;
+	flex_int32_t cols;	/* -Cf: the row length of nxt; 0 when compressed */
+	struct flex_tbl accept, base, def, nxt, chk, ec, meta, nul_trans, trail;
+	};
+
+static flex_int32_t get_int (const unsigned char *p, int size)
+{
+	switch (size) {
+	case 1:
+		return (flex_int8_t) p[0];
+	case 2:
+		return (flex_int16_t) ((p[0] << 8) | p[1]);
+	default:
+		return (flex_int32_t) (((flex_uint32_t) p[0] << 24)
+				       | ((flex_uint32_t) p[1] << 16)
+				       | ((flex_uint32_t) p[2] << 8)
+				       | (flex_uint32_t) p[3]);
+	}
+}
+
+static flex_uint32_t get_uint (const unsigned char *p, int size)
+{
+	return size == 2 ? (flex_uint32_t) ((p[0] << 8) | p[1])
+		: (flex_uint32_t) get_int (p, 4);
+}
+
+/* Which member of dfa keeps the table with id td_id, or NULL if the
+ * matcher has no use for it.
+ */
+static struct flex_tbl *dfa_table (struct flex_dfa *dfa, int td_id)
+{
+	switch (td_id) {
+	case YYTD_ID_ACCEPT:	return &dfa->accept;
+	case YYTD_ID_BASE:	return &dfa->base;
+	case YYTD_ID_CHK:	return &dfa->chk;
+	case YYTD_ID_DEF:	return &dfa->def;
+	case YYTD_ID_EC:	return &dfa->ec;
+	case YYTD_ID_META:	return &dfa->meta;
+	case YYTD_ID_NUL_TRANS:	return &dfa->nul_trans;
+	case YYTD_ID_NXT:	return &dfa->nxt;
+	case YYTD_ID_RULE_TRAIL:	return &dfa->trail;
+	default:		return NULL;
+	}
+}
+
+/* in_range - whether every entry of tbl is at least lo and below hi */
+static int in_range (const struct flex_tbl *tbl, flex_int32_t lo, flex_int32_t hi)
+{
+	flex_int32_t i;
+
+	for (i = 0; i < tbl->len; ++i)
+		if (tbl->data[i] < lo || tbl->data[i] >= hi)
+			return 0;
+	return 1;
+}
+
+/* check_dfa - make sure no table lookup while matching can go out of
+ * bounds, so tables from elsewhere cannot make us read wild memory
+ */
+static int check_dfa (const struct flex_dfa *dfa)
+{
+	flex_int32_t nstates, ncols, i;
+
+	if (dfa->rules < 0 || dfa->start_conditions < 1 || !dfa->accept.data
+	    || !in_range (&dfa->accept, 0, dfa->rules + 3)
+	    || (dfa->trail.data && dfa->trail.len != dfa->rules + 2)
+	    || dfa->nul_ec < 1
+	    || (dfa->ec.data && !in_range (&dfa->ec, 0, INT32_MAX)))
+		return 0;
+
+	if (dfa->cols > 0) {
+		/* A transition of -s jams in state s. */
+		nstates = dfa->nxt.len / dfa->cols;
+		return 2 * dfa->start_conditions < nstates
+			&& dfa->accept.len >= nstates
+			&& in_range (&dfa->nxt, 1 - nstates, nstates)
+			&& (!dfa->nul_trans.data
+			    || (dfa->nul_trans.len >= nstates
+				&& in_range (&dfa->nul_trans, 1 - nstates, nstates)));
+	}
+
+	if (!dfa->base.data || !dfa->def.data || !dfa->nxt.data || !dfa->chk.data
+	    || dfa->nxt.len != dfa->chk.len || dfa->def.len != dfa->base.len)
+		return 0;
+
+	/* Every class an input character can have, and every
+	 * meta-equivalence class, must index within nxt from any base.
+	 */
+	ncols = dfa->nul_ec;
+	for (i = 0; dfa->ec.data && i < dfa->ec.len; ++i)
+		if (dfa->ec.data[i] > ncols)
+			ncols = dfa->ec.data[i];
+	++ncols;
+	nstates = dfa->base.len;
+	if (2 * dfa->start_conditions > dfa->jamstate || dfa->jamstate >= nstates
+	    || dfa->accept.len <= dfa->jamstate
+	    || !in_range (&dfa->def, 0, nstates)
+	    || !in_range (&dfa->nxt, 0, dfa->jamstate + 1)
+	    || (dfa->meta.data && (dfa->meta.len < ncols
+				   || !in_range (&dfa->meta, 0, ncols))))
+		return 0;
+	for (i = 0; i < nstates; ++i)
+		if (dfa->base.data[i] < 0
+		    || dfa->base.data[i] + ncols > dfa->nxt.len)
+			return 0;
+	return 1;
+}
+
+struct flex_dfa *flex_dfa_load (const void *buf, size_t size)
+{
+	const unsigned char *set = buf, *p = buf, *end;
+	flex_uint32_t hsize, ssize;
+	struct flex_dfa *dfa;
+	int have_constants = 0, err = EINVAL;
+
+	if (size < 14 || get_uint (p, 4) != YYTBL_MAGIC)
+		goto bad;
+	hsize = get_uint (p + 4, 4);
+	ssize = get_uint (p + 8, 4);
+	if (hsize > ssize || ssize > size)
+		goto bad;
+	end = p + ssize;
+	p += hsize;
+
+	if ((dfa = calloc (1, sizeof (struct flex_dfa))) == NULL)
+		return NULL;
+
+	while (end - p >= 12) {
+		int     td_id = (int) get_uint (p, 2);
+		int     td_flags = (int) get_uint (p + 2, 2);
+		flex_uint32_t hilen = get_uint (p + 4, 4);
+		flex_uint32_t lolen = get_uint (p + 8, 4);
+		int     sz = (int) YYTDFLAGS2BYTES (td_flags);
+		flex_uint32_t n = hilen > 0 ? hilen * lolen : lolen, i;
+		struct flex_tbl *tbl;
+
+		p += 12;
+		if ((hilen > 0 && n / hilen != lolen) || n > (flex_uint32_t) INT32_MAX
+		    || (size_t) (end - p) / (size_t) sz < n)
+			goto fail;
+
+		if (td_id == YYTD_ID_ACCLIST || td_id == YYTD_ID_TRANSITION
+		    || td_id == YYTD_ID_START_STATE_LIST || (td_flags & YYTD_PTRANS)) {
+			err = ENOTSUP;
+			goto fail;
+		}
+
+		if (td_id == YYTD_ID_CONSTANTS) {
+			if (n < YYTC_SIZE)
+				goto fail;
+			dfa->rules = get_int (p + YYTC_END_OF_BUFFER * sz, sz) - 2;
+			dfa->jamstate = get_int (p + YYTC_JAMSTATE * sz, sz);
+			dfa->jambase = get_int (p + YYTC_JAMBASE * sz, sz);
+			dfa->nul_ec = get_int (p + YYTC_NUL_EC * sz, sz);
+			dfa->start_conditions = get_int (p + YYTC_START_CONDITIONS * sz, sz);
+			have_constants = 1;
+		}
+		else if ((tbl = dfa_table (dfa, td_id)) != NULL) {
+			if (tbl->data != NULL || n == 0)
+				goto fail;
+			if ((tbl->data = malloc (n * sizeof (flex_int32_t))) == NULL) {
+				err = ENOMEM;
+				goto fail;
+			}
+			tbl->len = (flex_int32_t) n;
+			for (i = 0; i < n; ++i)
+				tbl->data[i] = get_int (p + i * (flex_uint32_t) sz, sz);
+			if (td_id == YYTD_ID_NXT && hilen > 0)
+				dfa->cols = (flex_int32_t) lolen;
+		}
+
+		p += n * (flex_uint32_t) sz;
+		/* Tables are padded to a multiple of 8 bytes. */
+		p = set + (((size_t) (p - set) + 7) & ~(size_t) 7);
+	}
+
+	if (!have_constants || !check_dfa (dfa))
+		goto fail;
+	return dfa;
+
+ fail:
+	flex_dfa_free (dfa);
+ bad:
+	errno = err;
+	return NULL;
+}
+
+void flex_dfa_free (struct flex_dfa *dfa)
+{
+	if (dfa == NULL)
+		return;
+	free (dfa->accept.data);
+	free (dfa->base.data);
+	free (dfa->def.data);
+	free (dfa->nxt.data);
+	free (dfa->chk.data);
+	free (dfa->ec.data);
+	free (dfa->meta.data);
+	free (dfa->nul_trans.data);
+	free (dfa->trail.data);
+	free (dfa);
+}
+
+int flex_dfa_rules (const struct flex_dfa *dfa)
+{
+	return dfa->rules;
+}
+
+int flex_dfa_start_conditions (const struct flex_dfa *dfa)
+{
+	return dfa->start_conditions;
+}
+
+/* The equivalence class of c, or -1 if the tables have none for it. */
+#define DFA_EC(dfa, c) \
+	((c) == 0 ? (dfa)->nul_ec \
+	 : (dfa)->ec.data ? ((c) < (dfa)->ec.len ? (dfa)->ec.data[c] : -1) \
+	 : (c) < (dfa)->nul_ec ? (c) : -1)
+
+int flex_dfa_match (const struct flex_dfa *dfa, int sc, int at_bol,
+		    const char *text, size_t len, size_t *leng)
+{
+	const unsigned char *bp = (const unsigned char *) text;
+	const unsigned char *cp = bp, *end = bp + len;
+	const unsigned char *last_accepting_cpos = NULL;
+	flex_int32_t state, last_accepting_state = 0, act, yc;
+
+	if (sc < 0 || sc >= dfa->start_conditions) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (len == 0) {
+		*leng = 0;
+		return 0;
+	}
+
+	/* A start condition's second start state is for the beginning of
+	 * a line; it matches as the first does when no rule uses '^'.
+	 */
+	state = 1 + 2 * sc + (at_bol ? 1 : 0);
+
+	if (dfa->cols > 0) {
+		const flex_int32_t *nxt = dfa->nxt.data;
+
+		while (cp < end) {
+			flex_int32_t next;
+
+			if (*cp == 0 && dfa->nul_trans.data)
+				next = dfa->nul_trans.data[state];
+			else if ((yc = DFA_EC (dfa, *cp)) < 0 || yc >= dfa->cols)
+				next = -state;
+			else
+				next = nxt[state * dfa->cols + yc];
+
+			if (next <= 0) {
+				state = -next;
+				break;
+			}
+			state = next;
+			if (dfa->accept.data[state]) {
+				last_accepting_state = state;
+				last_accepting_cpos = cp;
+			}
+			++cp;
+		}
+
+		act = dfa->accept.data[state];
+		if (act == 0 && last_accepting_cpos) {
+			cp = last_accepting_cpos + 1;
+			act = dfa->accept.data[last_accepting_state];
+		}
+	}
+
+	else {
+		const flex_int32_t *base = dfa->base.data, *chk = dfa->chk.data;
+
+		for (;;) {
+			if (dfa->accept.data[state]) {
+				last_accepting_state = state;
+				last_accepting_cpos = cp;
+			}
+			if (cp == end)
+				break;
+			if ((yc = DFA_EC (dfa, *cp)) < 0) {
+				state = dfa->jamstate;
+				break;
+			}
+			while (chk[base[state] + yc] != state) {
+				state = dfa->def.data[state];
+				/* Templates come after the jam state. */
+				if (state >= dfa->jamstate + 1 && dfa->meta.data)
+					yc = dfa->meta.data[yc];
+			}
+			state = dfa->nxt.data[base[state] + yc];
+			++cp;
+			if (base[state] == dfa->jambase)
+				break;
+		}
+
+		act = dfa->accept.data[state];
+		if (act == 0 && last_accepting_cpos) {
+			cp = last_accepting_cpos;
+			act = dfa->accept.data[last_accepting_state];
+		}
+	}
+
+	if (act == 0 || act > dfa->rules + 1) {
+		errno = EILSEQ;
+		return -1;
+	}
+
+	*leng = (size_t) (cp - bp);
+	if (dfa->trail.data && dfa->trail.data[act] != 0) {
+		if (dfa->trail.data[act] > 0)
+			*leng = (size_t) dfa->trail.data[act];
+		else
+			*leng -= (size_t) -dfa->trail.data[act];
+	}
+	return act;
+}
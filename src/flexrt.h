@@ -0,0 +1,139 @@
+/* flexrt.h - interface to libflexrt, the shared scanner run-time */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+/* A C scanner generated with %option shared-runtime keeps its tables,
+ * its actions and yylex() itself, but leaves input buffer management to
+ * the functions declared here, so that a program linking many scanners
+ * carries one copy of them.  The generated file includes this header
+ * and links against libflexrt; nothing here is meant to be called
+ * directly.
+ */
+
+#ifndef FLEXRT_H
+#define FLEXRT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Must match the C layout in the skeleton. */
+#ifndef YY_STRUCT_YY_BUFFER_STATE
+#define YY_STRUCT_YY_BUFFER_STATE
+struct yy_buffer_state
+	{
+	FILE *yy_input_file;
+	char *yy_ch_buf;		/* input buffer */
+	char *yy_buf_pos;		/* current position in input buffer */
+	int yy_buf_size;
+	int yy_n_chars;
+	int yy_is_our_buffer;
+	int yy_is_interactive;
+	int yyatbol;
+	int yy_bs_lineno; /**< The line count. */
+	int yy_bs_column; /**< The column count. */
+	int yy_fill_buffer;
+	int yy_buffer_status;
+	};
+#endif /* !YY_STRUCT_YY_BUFFER_STATE */
+
+#define YY_BUFFER_NEW 0
+#define YY_BUFFER_NORMAL 1
+#define YY_BUFFER_EOF_PENDING 2
+
+#ifndef YY_STRUCT_YY_BUFFER_POLICY
+#define YY_STRUCT_YY_BUFFER_POLICY
+struct yy_buffer_policy
+	{
+	int yy_initial_size;	/* size of new buffers; 0 means YY_BUF_SIZE */
+	int yy_shrink_size;	/* shrink back to this after a long token; 0 means never */
+	int yy_release_idle;	/* shrink to yy_initial_size when no input is left over */
+	};
+#endif /* !YY_STRUCT_YY_BUFFER_POLICY */
+
+/* What one scanner needs from the run-time that the run-time cannot
+ * know: the scanner's allocator, YY_FATAL_ERROR, YY_INPUT and sizes.
+ * Each generated scanner has one, shared by all its instances.
+ */
+struct flexrt_ops
+	{
+	void *(*allocate) (size_t size, void *yyscanner);
+	void *(*reallocate) (void *ptr, size_t size, void *yyscanner);
+	void (*release) (void *ptr, void *yyscanner);
+	void (*fatal_error) (const char *msg, void *yyscanner);
+	int (*read_input) (char *buf, int max_size, void *yyscanner);
+	int buf_size;		/* YY_BUF_SIZE */
+	int read_buf_size;	/* YY_READ_BUF_SIZE */
+	int interactive;	/* 1 always, 0 never, -1 ask isatty() */
+	};
+
+/* Where one scanner instance keeps its input state.  A non-reentrant
+ * scanner has one of these pointing at its globals; a reentrant one
+ * keeps one in its yyguts_t.
+ */
+struct flexrt_scanner
+	{
+	const struct flexrt_ops *ops;
+	void *yyscanner;	/* passed back to the ops */
+	struct yy_buffer_state ***buffer_stack;
+	size_t *buffer_stack_top;
+	size_t *buffer_stack_max;
+	char **c_buf_p;
+	char *hold_char;
+	int *n_chars;
+	char **text_ptr;
+	int *more_len;	/* NULL unless the scanner uses yymore() */
+	FILE **in;
+	int *did_buffer_switch_on_eof;
+	const struct yy_buffer_policy *buffer_policy;	/* NULL with noyyset_buffer_policy */
+	};
+
+void flexrt_restart (struct flexrt_scanner *rt, FILE *input_file);
+void flexrt_switch_to_buffer (struct flexrt_scanner *rt,
+			      struct yy_buffer_state *new_buffer);
+void flexrt_load_buffer_state (struct flexrt_scanner *rt);
+struct yy_buffer_state *flexrt_create_buffer (struct flexrt_scanner *rt,
+					      FILE *file, int size);
+void flexrt_delete_buffer (struct flexrt_scanner *rt,
+			   struct yy_buffer_state *b);
+void flexrt_init_buffer (struct flexrt_scanner *rt,
+			 struct yy_buffer_state *b, FILE *file);
+void flexrt_flush_buffer (struct flexrt_scanner *rt,
+			  struct yy_buffer_state *b);
+void flexrt_push_buffer_state (struct flexrt_scanner *rt,
+			       struct yy_buffer_state *new_buffer);
+void flexrt_pop_buffer_state (struct flexrt_scanner *rt);
+void flexrt_ensure_buffer_stack (struct flexrt_scanner *rt);
+struct yy_buffer_state *flexrt_scan_buffer (struct flexrt_scanner *rt,
+					    char *base, size_t size);
+struct yy_buffer_state *flexrt_scan_bytes (struct flexrt_scanner *rt,
+					   const char *bytes, int len);
+int flexrt_get_next_buffer (struct flexrt_scanner *rt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLEXRT_H */
@@ -59,6 +59,50 @@ struct packtype_t *optimize_pack(size_t sz)
 	return &out;
 }
 
+/** Make the table of the constants the scanner is compiled with that
+ *  depend on the DFA, so that tables loaded later can be checked against
+ *  the scanner and bring their own.
+ *  @return the newly allocated constants table
+ */
+static struct yytbl_data *mkconsttbl (void)
+{
+	flex_int32_t *tdata = 0;
+	struct yytbl_data *tbl;
+
+	tbl = calloc(1, sizeof (struct yytbl_data));
+	yytbl_data_init (tbl, YYTD_ID_CONSTANTS);
+	tbl->td_flags = YYTD_DATA32;
+	tbl->td_lolen = YYTC_SIZE;
+	tbl->td_data = tdata =
+		calloc(tbl->td_lolen, sizeof (flex_int32_t));
+
+	tdata[YYTC_END_OF_BUFFER] = num_rules + 1;
+	tdata[YYTC_JAMSTATE] = jamstate;
+	tdata[YYTC_JAMBASE] = jambase;
+	tdata[YYTC_NUL_EC] = NUL_ec;
+	tdata[YYTC_START_CONDITIONS] = lastsc;
+
+	return tbl;
+}
+
+/* Generate the constants table, and write it to the tables file. */
+static void genconsttbl (void)
+{
+	char    buf[128];
+	struct yytbl_data *tbl;
+
+	tbl = mkconsttbl ();
+	snprintf (buf, sizeof (buf),
+		  "m4_define([[M4_HOOK_CONSTANTS_BODY]], [[%d, %d, %d, %d, %d]])",
+		  num_rules + 1, jamstate, jambase, NUL_ec, lastsc);
+	outn (buf);
+
+	yytbl_data_compress (tbl);
+	if (yytbl_data_fwrite (&tableswr, tbl) < 0)
+		flexerror (_("Could not write consttbl"));
+	yytbl_data_destroy (tbl);
+}
+
 /** Make the table for possible eol matches.
  *  @return the newly allocated rule_can_match_eol table
  */
@@ -105,6 +149,546 @@ static void geneoltbl (void)
 	outn ("]])");
 }
 
+/* Generate the table of trailing-context length adjustments used by
+ * yylex_parallel(), yylex_interleaved() and yylex_batch(), which never
+ * run the actions that normally do them.
+ */
+static void gentrailtbl (void)
+{
+	int     i, maxtrail = 0;
+	struct packtype_t *ptype;
+
+	for (i = 1; i <= num_rules; i++)
+		if (ABS (rule_trail[i]) > maxtrail)
+			maxtrail = ABS (rule_trail[i]);
+
+	ptype = optimize_pack((size_t) maxtrail);
+	out_str ("m4_define([[M4_HOOK_TRAILTABLE_TYPE]], [[%s]])\n", ptype->name);
+	out_dec ("m4_define([[M4_HOOK_TRAILTABLE_SIZE]], [[%d]])", num_rules + 1);
+	outn ("m4_define([[M4_HOOK_TRAILTABLE_BODY]], [[m4_dnl");
+
+	for (i = 1; i <= num_rules; i++) {
+		out_dec ("%d, ", rule_trail[i]);
+		/* format nicely, 20 numbers per line. */
+		if ((i % 20) == 19)
+			out ("\n    ");
+	}
+	footprint += num_rules * ptype->width;
+	outn ("]])");
+}
+
+/** Make the table of trailing-context length adjustments.
+ *  @return the newly allocated rule_trail table
+ */
+static struct yytbl_data *mktrailtbl (void)
+{
+	int     i;
+	flex_int32_t *tdata = 0;
+	struct yytbl_data *tbl;
+
+	tbl = calloc(1, sizeof (struct yytbl_data));
+	yytbl_data_init (tbl, YYTD_ID_RULE_TRAIL);
+	tbl->td_flags = YYTD_DATA32;
+	tbl->td_lolen = (flex_uint32_t) (num_rules + 1);
+	tbl->td_data = tdata =
+		calloc(tbl->td_lolen, sizeof (flex_int32_t));
+
+	for (i = 1; i <= num_rules; i++)
+		tdata[i] = rule_trail[i];
+
+	return tbl;
+}
+
+/* Write the trailing-context table to the tables file, for
+ * --tables-trail.  It comes last, once the scanner is complete, so
+ * tables that have it are whole.
+ */
+void gentrailfile (void)
+{
+	struct yytbl_data *tbl;
+
+	tbl = mktrailtbl ();
+	yytbl_data_compress (tbl);
+	if (yytbl_data_fwrite (&tableswr, tbl) < 0)
+		flexerror (_("Could not write trailtbl"));
+	yytbl_data_destroy (tbl);
+	if (fflush (tableswr.out) != 0)
+		lerr (_("error writing output file %s"), tablesfilename);
+}
+
+/* Generate the table of skip rules, those with empty actions. */
+static void genskiptbl (void)
+{
+	int     i;
+
+	outn ("m4_define([[M4_HOOK_SKIPTABLE_TYPE]], [[flex_int8_t]])");
+	out_dec ("m4_define([[M4_HOOK_SKIPTABLE_SIZE]], [[%d]])", num_rules + 2);
+	outn ("m4_define([[M4_HOOK_SKIPTABLE_BODY]], [[m4_dnl");
+
+	for (i = 1; i <= num_rules; i++) {
+		out_dec ("%d, ", rule_skip[i] ? 1 : 0);
+		/* format nicely, 20 numbers per line. */
+		if ((i % 20) == 19)
+			out ("\n    ");
+	}
+	footprint += num_rules + 2;
+	outn ("]])");
+}
+
+/* Generate the table of echo rules, those whose actions only ECHO. */
+static void genechotbl (void)
+{
+	int     i;
+
+	outn ("m4_define([[M4_HOOK_ECHOTABLE_TYPE]], [[flex_int8_t]])");
+	out_dec ("m4_define([[M4_HOOK_ECHOTABLE_SIZE]], [[%d]])", num_rules + 1);
+	outn ("m4_define([[M4_HOOK_ECHOTABLE_BODY]], [[m4_dnl");
+
+	for (i = 1; i <= num_rules; i++) {
+		out_dec ("%d, ", rule_echo[i] ? 1 : 0);
+		/* format nicely, 20 numbers per line. */
+		if ((i % 20) == 19)
+			out ("\n    ");
+	}
+	footprint += num_rules + 1;
+	outn ("]])");
+}
+
+/* Generate the _TYPE, _SIZE and _BODY hooks of a table whose entry 0 is
+ * always 0.
+ */
+static void genhooktbl (const char *hook, const int *data, int size)
+{
+	int     i, maxval = 0;
+	char    fmt[128];
+	struct packtype_t *ptype;
+
+	for (i = 1; i < size; ++i)
+		if (data[i] > maxval)
+			maxval = data[i];
+
+	ptype = optimize_pack((size_t) maxval);
+	snprintf (fmt, sizeof (fmt), "m4_define([[%s_TYPE]], [[%%s]])", hook);
+	out_str (fmt, ptype->name);
+	snprintf (fmt, sizeof (fmt), "m4_define([[%s_SIZE]], [[%%d]])", hook);
+	out_dec (fmt, size);
+	snprintf (fmt, sizeof (fmt), "m4_define([[%s_BODY]], [[m4_dnl", hook);
+	outn (fmt);
+
+	for (i = 1; i < size; ++i)
+		mkdata (data[i]);
+
+	dataend (NULL);
+	outn ("]])");
+	footprint += size * ptype->width;
+}
+
+/* genchunktbl - generate the table of states a %chunked token can be cut in
+ *
+ * yy_chunk[s] is the rule a token that has reached state s is sure to be
+ * matched by, if that is a %chunked rule: s accepts it, and every
+ * accepting state reachable from s accepts it too.  The token then can
+ * neither back up to before where it reached s nor go to another rule,
+ * so the scanner can hand the text so far to the program and go on from
+ * s.  Otherwise it is 0.
+ */
+static void genchunktbl (void)
+{
+	int    *reach;
+	int     s, ec, next, rule, changed;
+
+	/* reach[s] is the one rule accepted in s or after it, 0 if there
+	 * is none, or -1 if there are several.
+	 */
+	reach = allocate_integer_array (lastdfa + 2);
+	for (s = 1; s <= lastdfa; ++s)
+		reach[s] = dfaacc[s].dfaacc_state;
+
+	do {
+		changed = false;
+		for (s = lastdfa; s >= 1; --s)
+			for (ec = 1; ec <= numecs && reach[s] >= 0; ++ec) {
+				next = dfa_nxt[s * (numecs + 1) + ec];
+				if (next <= 0 || next > lastdfa || reach[next] == 0
+				    || reach[next] == reach[s])
+					continue;
+				reach[s] = reach[s] == 0 ? reach[next] : -1;
+				changed = true;
+			}
+	} while (changed);
+
+	for (s = 1; s <= lastdfa; ++s) {
+		rule = dfaacc[s].dfaacc_state;
+		if (rule <= 0 || rule > num_rules || !rule_chunked[rule]
+		    || reach[s] != rule)
+			reach[s] = 0;
+	}
+	/* The jam state. */
+	reach[lastdfa + 1] = 0;
+
+	genhooktbl ("M4_HOOK_CHUNK", reach, lastdfa + 2);
+	free (reach);
+}
+
+/* gentrailtags - generate the position tag tables for variable trailing
+ * context
+ *
+ * Each variable trailing context rule gets a tag, numbered from 1, that
+ * holds where its head last ended.  For each state yy_trail_ops lists the
+ * tags whose heads end there, then minus the tag of the rule it accepts
+ * if that has variable trailing context, and a 0; the scanner sets the
+ * former to the current position and copies the latter to tag 0, which
+ * the rule's action then splits the token at.  yy_trail_base says where
+ * a state's list starts, or is 0 if it has nothing to do.
+ */
+static void gentrailtags (void)
+{
+	int    *tag, *base, *ops, *mark;
+	int     i, s, rule, ntags = 0, nops = 1, maxops = 1;
+
+	tag = allocate_integer_array (num_rules + 1);
+	for (i = 1; i <= num_rules; ++i)
+		tag[i] = rule_type[i] == RULE_VARIABLE ? ++ntags : 0;
+
+	for (s = 1; s <= lastdfa; ++s)
+		maxops += dfasiz[s] + 2;
+
+	base = allocate_integer_array (lastdfa + 2);
+	ops = allocate_integer_array (maxops);
+	mark = allocate_integer_array (ntags + 1);
+	for (i = 0; i <= ntags; ++i)
+		mark[i] = 0;
+	ops[0] = 0;
+
+	for (s = 1; s <= lastdfa; ++s) {
+		base[s] = nops;
+
+		for (i = 1; i <= dfasiz[s]; ++i) {
+			int     anum = accptnum[dss[s][i]];
+
+			if (!(anum & YY_TRAILING_HEAD_MASK))
+				continue;
+			rule = anum & ~YY_TRAILING_HEAD_MASK;
+			if (tag[rule] && mark[tag[rule]] != s) {
+				mark[tag[rule]] = s;
+				ops[nops++] = tag[rule];
+			}
+		}
+
+		rule = dfaacc[s].dfaacc_state;
+		if (rule > 0 && rule <= num_rules && tag[rule])
+			ops[nops++] = -tag[rule];
+
+		if (nops > base[s])
+			ops[nops++] = 0;
+		else
+			base[s] = 0;
+	}
+	/* The jam state. */
+	base[lastdfa + 1] = 0;
+
+	out_dec ("m4_define([[M4_HOOK_TRAIL_TAGS]], [[%d]])", ntags);
+	genhooktbl ("M4_HOOK_TRAIL_BASE", base, lastdfa + 2);
+	genhooktbl ("M4_HOOK_TRAIL_OPS", ops, nops);
+
+	free (tag);
+	free (base);
+	free (ops);
+	free (mark);
+}
+
+/* genlazytbls - generate the tables for %option lazy-dfa
+ *
+ * Instead of a DFA we write out the NFA, and the scanner does the
+ * subset construction itself, one state at a time, as the input asks
+ * for it.  Each NFA state with a symbol transition gets a row of a bit
+ * table saying which equivalence classes it moves on; row 0 is empty
+ * and belongs to the epsilon states.
+ */
+static void genlazytbls (void)
+{
+	int     i, j, ns, sym, ch, row, nrows, nbytes, num_starts;
+	int    *setrow, *next1, *next2, *accept, *starts, *ecrow, *cclrow;
+	unsigned char *rows;
+
+	/* Make the start states the same way ntod() does; this may add
+	 * NFA states, so it has to come first.
+	 */
+	num_starts = lastsc * 2;
+	starts = calloc ((size_t) num_starts + 1, sizeof (int));
+
+	for (i = 1; i <= num_starts; ++i) {
+		if (i % 2 == 1)
+			starts[i] = scset[(i / 2) + 1];
+		else
+			starts[i] = mkbranch (scbol[i / 2], scset[i / 2]);
+	}
+
+	/* Bits 1 .. numecs; bit 0 is the end-of-buffer class. */
+	nbytes = (numecs + 8) / 8;
+
+	setrow = calloc ((size_t) lastnfa + 1, sizeof (int));
+	next1 = calloc ((size_t) lastnfa + 1, sizeof (int));
+	next2 = calloc ((size_t) lastnfa + 1, sizeof (int));
+	accept = calloc ((size_t) lastnfa + 1, sizeof (int));
+	ecrow = calloc ((size_t) numecs + 1, sizeof (int));
+	cclrow = calloc ((size_t) lastccl + 1, sizeof (int));
+	rows = calloc ((size_t) (numecs + lastccl + 1) * (size_t) nbytes, 1);
+
+	if (!starts || !setrow || !next1 || !next2 || !accept || !ecrow
+	    || !cclrow || !rows)
+		flexfatal (_("memory allocation failed in genlazytbls()"));
+
+	nrows = 1;
+
+	for (ns = 1; ns <= lastnfa; ++ns) {
+		sym = transchar[ns];
+		next1[ns] = trans1[ns];
+		next2[ns] = trans2[ns];
+		accept[ns] = accptnum[ns];
+
+		if (sym == SYM_EPSILON)
+			continue;
+
+		if (sym < 0) {	/* it's a character class */
+			sym = -sym;
+
+			if (!cclrow[sym]) {
+				unsigned char *bits = rows + nrows * nbytes;
+				int     lenccl = ccllen[sym];
+				int     ccllist = cclmap[sym];
+
+				if (cclng[sym])
+					for (ch = 1; ch <= numecs; ++ch)
+						bits[ch / 8] |= (unsigned char) (1 << (ch % 8));
+
+				for (j = 0; j < lenccl; ++j) {
+					ch = ccltbl[ccllist + j];
+
+					if (ch == 0)
+						ch = NUL_ec;
+
+					if (cclng[sym])
+						bits[ch / 8] &= (unsigned char) ~(1 << (ch % 8));
+					else
+						bits[ch / 8] |= (unsigned char) (1 << (ch % 8));
+				}
+
+				cclrow[sym] = nrows++;
+			}
+
+			row = cclrow[sym];
+		}
+
+		else {
+			ch = ABS (ecgroup[sym]);
+
+			if (!ecrow[ch]) {
+				rows[nrows * nbytes + ch / 8] |= (unsigned char) (1 << (ch % 8));
+				ecrow[ch] = nrows++;
+			}
+
+			row = ecrow[ch];
+		}
+
+		setrow[ns] = row;
+	}
+
+	/* The lazy DFA jams the same way the compressed tables do. */
+	++num_backing_up;
+
+	out_str_dec ("M4_HOOK_CONST_DEFINE_UINT(%s, %d)", "YY_LAZY_NUM_EC", numecs + 1);
+	out_str_dec ("M4_HOOK_CONST_DEFINE_UINT(%s, %d)", "YY_LAZY_NUM_NFA", lastnfa + 1);
+	out_str_dec ("M4_HOOK_CONST_DEFINE_UINT(%s, %d)", "YY_LAZY_SET_BYTES", nbytes);
+
+	genhooktbl ("M4_HOOK_LAZY_SET", setrow, lastnfa + 1);
+	genhooktbl ("M4_HOOK_LAZY_NEXT1", next1, lastnfa + 1);
+	genhooktbl ("M4_HOOK_LAZY_NEXT2", next2, lastnfa + 1);
+	genhooktbl ("M4_HOOK_LAZY_ACCEPT", accept, lastnfa + 1);
+	genhooktbl ("M4_HOOK_LAZY_START", starts, num_starts + 1);
+
+	out_dec ("m4_define([[M4_HOOK_LAZY_ECSET_SIZE]], [[%d]])", nrows * nbytes);
+	outn ("m4_define([[M4_HOOK_LAZY_ECSET_BODY]], [[m4_dnl");
+
+	for (i = 1; i < nrows * nbytes; ++i)
+		mkdata (rows[i]);
+
+	dataend (NULL);
+	outn ("]])");
+	footprint += nrows * nbytes;
+
+	free (starts);
+	free (setrow);
+	free (next1);
+	free (next2);
+	free (accept);
+	free (ecrow);
+	free (cclrow);
+	free (rows);
+}
+
+/* genshuffletbl - generate the byte-shuffle table for %option shuffle-dfa
+ *
+ * Called after gentabs(), once the compressed tables are final.  The
+ * table has a 16-byte row for every input byte; lane s of a row is the
+ * state entered from state s on that byte, with lane 0 standing for the
+ * jam state.  Byte 0 is the end-of-buffer character and takes every state
+ * to the end-of-buffer state, which itself jams, just as the compressed
+ * tables do.  YY_SHUFFLE_ACCEPT has bit s set if state s accepts and
+ * YY_SHUFFLE_DEAD if the compressed tables give it the jam base, which
+ * is where an interactive scanner stops.
+ */
+
+static void genshuffletbl (void)
+{
+	int     c, s, next, ec;
+	int     accept = 0, dead = 1;
+
+	for (s = 1; s <= lastdfa; ++s) {
+		if (dfaacc[s].dfaacc_state)
+			accept |= 1 << s;
+		if (base[s] == jambase)
+			dead |= 1 << s;
+	}
+
+	out_str_dec ("M4_HOOK_CONST_DEFINE_UINT(%s, %d)", "YY_SHUFFLE_ACCEPT", accept);
+	out_str_dec ("M4_HOOK_CONST_DEFINE_UINT(%s, %d)", "YY_SHUFFLE_DEAD", dead);
+
+	/* Always 256 rows, so a stray 8-bit byte in a 7-bit scanner jams
+	 * rather than indexing past the table.
+	 */
+	out_dec ("m4_define([[M4_HOOK_SHUFFLE_SIZE]], [[%d]])", 256 * 16);
+	outn ("m4_define([[M4_HOOK_SHUFFLE_BODY]], [[m4_dnl");
+
+	for (c = 0; c < 256; ++c) {
+		ec = c < ctrl.csize ? ABS (ecgroup[c]) : 0;
+
+		for (s = 0; s < 16; ++s) {
+			if (s == 0 || s > lastdfa || (c > 0 && ec == 0))
+				next = 0;
+			else if (c == 0)
+				next = s == end_of_buffer_state ? 0 : end_of_buffer_state;
+			else
+				next = dfa_nxt[s * (numecs + 1) + ec];
+
+			if (c > 0 || s > 0)
+				mkdata (next);
+		}
+	}
+
+	dataend (NULL);
+	outn ("]])");
+	footprint += 256 * 16;
+
+	visible_define ("M4_MODE_SHUFFLE_DFA");
+}
+
+/* stride_step - the state entered from state s on class ec, or jam */
+
+static int stride_step (int s, int ec, int jam)
+{
+	int     next;
+
+	if (ec == 0)
+		/* The end-of-buffer character. */
+		return s == end_of_buffer_state ? jam : end_of_buffer_state;
+
+	next = dfa_nxt[s * (numecs + 1) + ec];
+	return next ? next : jam;
+}
+
+/* genstridetbls - generate the tables for -Cs2
+ *
+ * yy_stride_nxt1 is the plain transition table, numecs + 1 classes per
+ * state, and yy_stride_nxt2 gives for each state and pair of classes the
+ * state two steps on.  The scanner looks up both at once, so it only
+ * waits on one load every two bytes; the middle state is still there to
+ * check for accepting and jamming.  The jam state is jamstate with
+ * compressed tables and 0 with -Cf.
+ *
+ * Generates nothing, so that the scanner steps one byte at a time, if
+ * the pair table would be larger than STRIDE_MAX_BYTES.
+ */
+
+static void genstridetbls (void)
+{
+	int     nec = numecs + 1;
+	int     jam = ctrl.fulltbl ? 0 : jamstate;
+	int     s, ec1, ec2, mid, *nxt1, *nxt2;
+	size_t  size2 = (size_t) (lastdfa + 1) * (size_t) nec * (size_t) nec;
+
+	/* The width is in bits. */
+	if (size2 * (optimize_pack ((size_t) lastdfa + 1)->width / 8) > STRIDE_MAX_BYTES)
+		return;
+
+	nxt1 = allocate_integer_array ((lastdfa + 1) * nec);
+	nxt2 = allocate_integer_array ((int) size2);
+
+	for (ec1 = 0; ec1 < nec; ++ec1)
+		nxt1[ec1] = 0;
+	for (ec1 = 0; ec1 < nec * nec; ++ec1)
+		nxt2[ec1] = 0;
+
+	for (s = 1; s <= lastdfa; ++s)
+		for (ec1 = 0; ec1 < nec; ++ec1) {
+			mid = stride_step (s, ec1, jam);
+			nxt1[s * nec + ec1] = mid;
+
+			for (ec2 = 0; ec2 < nec; ++ec2)
+				nxt2[(s * nec + ec1) * nec + ec2] =
+					mid == jam ? jam : stride_step (mid, ec2, jam);
+		}
+
+	out_str_dec ("M4_HOOK_CONST_DEFINE_UINT(%s, %d)", "YY_STRIDE_NUM_EC", nec);
+	genhooktbl ("M4_HOOK_STRIDE1", nxt1, (lastdfa + 1) * nec);
+	genhooktbl ("M4_HOOK_STRIDE2", nxt2, (int) size2);
+	visible_define ("M4_MODE_STRIDE2");
+
+	free (nxt1);
+	free (nxt2);
+}
+
+
+/* genhybridtbl - generate the dense rows for -Ch
+ *
+ * The state whose yy_base is -r * (numecs + 1) has its transitions in
+ * row r of yy_dense, which starts at that same index, so the scanner
+ * finds the next state at yy_dense[yy_c - yy_base[state]].  Class 0,
+ * the end-of-buffer character, leads to the end-of-buffer state, as it
+ * does through the jam state in the compressed tables.  Row 0 is never
+ * used.
+ *
+ * Generates nothing if no state got a row.
+ */
+
+static void genhybridtbl (void)
+{
+	int     nec = numecs + 1;
+	int     size = (num_dense_rows + 1) * nec;
+	int     s, ec, next, *rows;
+
+	if (num_dense_rows == 0)
+		return;
+
+	rows = allocate_integer_array (size);
+	for (ec = 0; ec < size; ++ec)
+		rows[ec] = 0;
+
+	for (s = 1; s <= lastdfa; ++s)
+		if (dense_row[s]) {
+			rows[dense_row[s] * nec] = end_of_buffer_state;
+			for (ec = 1; ec < nec; ++ec) {
+				next = dfa_nxt[s * nec + ec];
+				rows[dense_row[s] * nec + ec] = next ? next : jamstate;
+			}
+		}
+
+	genhooktbl ("M4_HOOK_DENSE", rows, size);
+	visible_define ("M4_MODE_HYBRID");
+
+	free (rows);
+}
+
 
 /** mkctbl - make full speed compressed transition table
  * This is an array of structs; each struct a pair of integers.
@@ -722,7 +1306,10 @@ void gentabs (void)
 
 	/* Begin generating yy_base */
 	sz = total_states + 1;
-	ptype = optimize_pack(sz);
+	/* The entries go up to tblend, and with -Ch down to minus the
+	 * start of the last dense row.
+	 */
+	ptype = optimize_pack(MAX (sz, MAX (tblend + 1, (num_dense_rows + 1) * (numecs + 1))));
 	out_str ("m4_define([[M4_HOOK_BASE_TYPE]], [[%s]])", ptype->name);
 	out_dec ("m4_define([[M4_HOOK_BASE_SIZE]], [[%d]])", sz);
 	outn ("m4_define([[M4_HOOK_BASE_BODY]], [[m4_dnl");
@@ -738,7 +1325,10 @@ void gentabs (void)
 	for (i = 1; i <= lastdfa; ++i) {
 		int d = def[i];
 
-		if (base[i] == JAMSTATE)
+		if (dense_row && dense_row[i])
+			base[i] = -dense_row[i] * (numecs + 1);
+
+		else if (base[i] == JAMSTATE)
 			base[i] = jambase;
 
 		if (d == JAMSTATE)
@@ -923,6 +1513,9 @@ void make_tables (void)
 
 	/* This is where we REALLY begin generating the tables. */
 
+	if (tablesext)
+		genconsttbl ();
+
 	if (ctrl.fullspd) {
 		genctbl ();
 		if (tablesext) {
@@ -954,6 +1547,8 @@ void make_tables (void)
 	}
 	else if (ctrl.fulltbl) {
 		genftbl ();
+		if (ctrl.stride == 2)
+			genstridetbls ();
 		if (tablesext) {
 			struct yytbl_data *tbl;
 
@@ -979,8 +1574,24 @@ void make_tables (void)
 			}
 		}
 	}
-	else
+	else if (ctrl.lazy_dfa) {
+		genlazytbls ();
+		if (ctrl.useecs)
+			genecs ();
+	}
+	else {
 		gentabs ();
+		if (ctrl.hybrid)
+			genhybridtbl ();
+
+		/* Too many states for a shuffle is not an error; the scanner
+		 * simply runs on the compressed tables.
+		 */
+		if (ctrl.shuffle_dfa && lastdfa <= SHUFFLE_MAX_STATES)
+			genshuffletbl ();
+		else if (ctrl.stride == 2)
+			genstridetbls ();
+	}
 
 	snprintf(buf, sizeof(buf), "footprint: %ld bytes\n", footprint);
 	comment(buf);
@@ -1071,6 +1682,21 @@ void make_tables (void)
 		/* End generating yy_NUL_trans */
 	}
 
+	if (ctrl.parallel || ctrl.interleave || ctrl.token_batch)
+		gentrailtbl ();
+
+	if (num_skip_rules > 0)
+		genskiptbl ();
+
+	if (trail_tags)
+		gentrailtags ();
+
+	if (num_chunked_rules > 0)
+		genchunktbl ();
+
+	if (ctrl.echo_spans)
+		genechotbl ();
+
 	if (ctrl.ddebug) {		/* Spit out table mapping rules to line numbers. */
 		/* Policy choice: we don't include this space
 		 * in the table metering.
@@ -0,0 +1,240 @@
+/* libflex - run the scanner generator from a program */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+#include "flexdef.h"
+#include "tables.h"
+#include "libflex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+
+extern char **environ;
+
+/* flex_main() keeps its state in globals, exits through a longjmp and
+ * closes stdout, so it cannot run in the caller's process, nor in a
+ * forked copy of a threaded one.  flex_compile() runs the flex program
+ * instead, with posix_spawnp(), reading the rules on its standard input
+ * and writing the tables to descriptor 3 and its diagnostics to its
+ * standard error, each an unlinked temporary file.  The scanner itself
+ * goes to /dev/null.
+ */
+
+/* read_stream - read all of f, from the start, into a buffer allocated
+ * with malloc()
+ *
+ * The buffer has a NUL after the contents, so text can be used as a
+ * string.
+ */
+static char *read_stream (FILE *f, size_t *size)
+{
+	char   *buf = NULL, *p;
+	size_t  n = 0, max = 0;
+
+	rewind (f);
+	do {
+		if (n + 1 >= max) {
+			max = max ? max * 2 : 4096;
+			if ((p = realloc (buf, max)) == NULL) {
+				free (buf);
+				return NULL;
+			}
+			buf = p;
+		}
+		n += fread (buf + n, 1, max - n - 1, f);
+	} while (!feof (f) && !ferror (f));
+
+	if (ferror (f)) {
+		free (buf);
+		return NULL;
+	}
+	buf[n] = '\0';
+	if (size)
+		*size = n;
+	return buf;
+}
+
+static flex_uint32_t get_uint (const unsigned char *p, int size)
+{
+	flex_uint32_t v = 0;
+
+	while (size-- > 0)
+		v = (v << 8) | *p++;
+	return v;
+}
+
+/* has_trail_table - whether tables that loaded have the trailing
+ * context table, which flex writes only once it has otherwise succeeded
+ */
+static int has_trail_table (const void *buf)
+{
+	const unsigned char *set = buf, *p, *end;
+	flex_uint32_t n;
+
+	end = set + get_uint (set + 8, 4);
+	for (p = set + get_uint (set + 4, 4); end - p >= 12;) {
+		if (get_uint (p, 2) == YYTD_ID_RULE_TRAIL)
+			return 1;
+		n = get_uint (p + 4, 4) > 0 ? get_uint (p + 4, 4) * get_uint (p + 8, 4)
+			: get_uint (p + 8, 4);
+		p += 12 + n * YYTDFLAGS2BYTES (get_uint (p + 2, 2));
+		/* Tables are padded to a multiple of 8 bytes. */
+		p = set + (((size_t) (p - set) + 7) & ~(size_t) 7);
+	}
+	return 0;
+}
+
+/* spawn_flex - start flex on the rules in in, with the tables to go to
+ * out and the diagnostics to err
+ *
+ * Returns 0, or an errno value.
+ */
+static int spawn_flex (pid_t *pid, char **argv, FILE *in, FILE *out, FILE *err)
+{
+	const char *flex = getenv ("FLEX");
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	sigset_t sigs;
+	int     rv;
+
+	if (!flex || !*flex)
+		flex = FLEX_PATH;
+
+	if ((rv = posix_spawn_file_actions_init (&actions)) != 0)
+		return rv;
+	if ((rv = posix_spawnattr_init (&attr)) != 0) {
+		posix_spawn_file_actions_destroy (&actions);
+		return rv;
+	}
+
+	/* flex waits for the m4 it runs, so it must not inherit a
+	 * SIGCHLD the caller ignores, or signals the caller blocks.
+	 */
+	sigemptyset (&sigs);
+	if ((rv = posix_spawnattr_setsigmask (&attr, &sigs)) == 0) {
+		sigaddset (&sigs, SIGCHLD);
+		sigaddset (&sigs, SIGPIPE);
+		rv = posix_spawnattr_setsigdefault (&attr, &sigs);
+	}
+	if (rv == 0)
+		rv = posix_spawnattr_setflags (&attr, POSIX_SPAWN_SETSIGMASK
+					       | POSIX_SPAWN_SETSIGDEF);
+	if (rv == 0)
+		rv = posix_spawn_file_actions_adddup2 (&actions, fileno (in), 0);
+	if (rv == 0)
+		rv = posix_spawn_file_actions_addopen (&actions, 1, "/dev/null",
+						       O_WRONLY, 0);
+	if (rv == 0)
+		rv = posix_spawn_file_actions_adddup2 (&actions, fileno (err), 2);
+	if (rv == 0)
+		rv = posix_spawn_file_actions_adddup2 (&actions, fileno (out), 3);
+	if (rv == 0)
+		rv = posix_spawnp (pid, flex, &actions, &attr, argv, environ);
+
+	posix_spawnattr_destroy (&attr);
+	posix_spawn_file_actions_destroy (&actions);
+	return rv;
+}
+
+int flex_compile (const char *rules, const char *const *options,
+		  void **tables, size_t *size, char **errors)
+{
+	static const char *const fixed[] = {
+		"flex", "-t", "--tables-file=/dev/fd/3", "--tables-trail"
+	};
+	char  **argv;
+	char   *msg = NULL, *buf = NULL;
+	FILE   *in = NULL, *out = NULL, *err = NULL;
+	struct flex_dfa *dfa;
+	int     argc = 0, nopts = 0, status, rv, unsupported, ok = 0;
+	pid_t   pid;
+
+	if (errors)
+		*errors = NULL;
+	while (options && options[nopts])
+		++nopts;
+	if ((argv = calloc ((size_t) nopts + 5, sizeof (char *))) == NULL)
+		return -1;
+	for (; argc < 4; ++argc)
+		argv[argc] = (char *) fixed[argc];
+	while (nopts-- > 0)
+		argv[argc++] = (char *) *options++;
+
+	if ((in = tmpfile ()) == NULL || (out = tmpfile ()) == NULL
+	    || (err = tmpfile ()) == NULL
+	    || fputs (rules, in) == EOF || fflush (in) != 0
+	    || fseek (in, 0L, SEEK_SET) != 0)
+		goto done;
+
+	if ((rv = spawn_flex (&pid, argv, in, out, err)) != 0) {
+		errno = rv;
+		goto done;
+	}
+
+	/* If the caller ignores SIGCHLD, flex is reaped for us: waitpid()
+	 * waits for it and then fails, and only the tables tell whether
+	 * it succeeded.
+	 */
+	while ((rv = waitpid (pid, &status, 0)) == -1 && errno == EINTR)
+		;
+
+	msg = read_stream (err, NULL);
+	if (rv != -1 && (!WIFEXITED (status) || WEXITSTATUS (status) != 0))
+		goto done;
+
+	/* The tables have to be ones we can match with. */
+	if ((buf = read_stream (out, size)) == NULL)
+		goto done;
+	if ((dfa = flex_dfa_load (buf, *size)) == NULL) {
+		unsupported = errno == ENOTSUP;
+		/* Unless flex, whose status we do not know, said why. */
+		if (rv != -1 || unsupported || !msg || !*msg) {
+			free (msg);
+			msg = strdup (unsupported
+				      ? _("REJECT, variable trailing context and -CF are not supported\n")
+				      : _("could not load the tables\n"));
+		}
+		goto done;
+	}
+	flex_dfa_free (dfa);
+	if (rv == -1 && !has_trail_table (buf))
+		goto done;
+	*tables = buf;
+	buf = NULL;
+	ok = 1;
+
+ done:
+	free (buf);
+	if (errors && !ok && msg && *msg)
+		*errors = msg;
+	else
+		free (msg);
+	if (in)
+		fclose (in);
+	if (out)
+		fclose (out);
+	if (err)
+		fclose (err);
+	free (argv);
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,95 @@
+/* libflex.h - compile flex rules at run time, and match with the result */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+/* flex_compile(), in libflex, runs the scanner generator on a flex
+ * input held in memory and returns the serialized tables it builds,
+ * the same format --tables-file writes.  The flex_dfa functions, in
+ * libflexrt, load such tables and match text with them, telling the
+ * caller which rule matched instead of running its action.  A program
+ * that only runs tables compiled elsewhere needs just libflexrt.
+ */
+
+#ifndef LIBFLEX_H
+#define LIBFLEX_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compile rules, a complete flex input, with the command-line options
+ * in the NULL-terminated array options (which may be NULL).  On
+ * success, returns 0 and sets *tables and *size to a buffer allocated
+ * with malloc().  On failure, returns -1 and, if errors is not NULL,
+ * sets *errors to flex's diagnostics, also allocated with malloc().
+ *
+ * flex_compile() runs the flex program, the one named by the FLEX
+ * environment variable or else the installed one, in a process of its
+ * own, so any number of threads may call it at once.  It waits for that
+ * process and no other; a caller that ignores SIGCHLD still gets the
+ * right answer, but one that reaps children it did not start must not
+ * do so while a compile runs.  The rules, tables and diagnostics pass
+ * through unlinked temporary files; nothing else is written, unless
+ * options asks for more, such as -o or --header-file, which write their
+ * files as flex would, relative to the current directory.
+ */
+int flex_compile (const char *rules, const char *const *options,
+		  void **tables, size_t *size, char **errors);
+
+/* Compiled tables, ready to match with. */
+struct flex_dfa;
+
+/* Load the tables in buf, which the caller may free afterwards.
+ * Returns NULL with errno set to EINVAL if they are malformed, to
+ * ENOTSUP if they need REJECT, variable trailing context or -CF, or to
+ * ENOMEM.
+ */
+struct flex_dfa *flex_dfa_load (const void *buf, size_t size);
+void flex_dfa_free (struct flex_dfa *dfa);
+
+/* The number of rules.  The default rule, which matches one character
+ * that no rule does, is one more.
+ */
+int flex_dfa_rules (const struct flex_dfa *dfa);
+
+/* The number of start conditions, counting INITIAL, which is 0.  The
+ * others are numbered in the order they are declared.
+ */
+int flex_dfa_start_conditions (const struct flex_dfa *dfa);
+
+/* Match the longest token at the start of the len bytes at text, in
+ * start condition sc, at the beginning of a line if at_bol.  Returns
+ * the number of the rule that matched, and sets *leng to the length of
+ * the token less any trailing context; returns 0 if len is 0, or -1
+ * with errno set to EINVAL if sc is out of range or to EILSEQ if no
+ * rule matches (a 7-bit scanner given an 8-bit character).
+ */
+int flex_dfa_match (const struct flex_dfa *dfa, int sc, int at_bol,
+		    const char *text, size_t len, size_t *leng);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBFLEX_H */
@@ -0,0 +1,477 @@
+/* libflexrt - flex run-time support library: input buffer management */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+/* These are the buffer functions of the C skeleton, written once against
+ * a struct flexrt_scanner instead of once per scanner against its
+ * globals or yyguts_t.  Keep them in step with cpp-flex.skl.
+ */
+
+#if !(defined(_POSIX_C_SOURCE) || defined(_XOPEN_SOURCE) || \
+    defined(_POSIX_SOURCE))
+# define _POSIX_C_SOURCE 1 /* Required for fileno() */
+# define _POSIX_SOURCE 1
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "flexrt.h"
+
+/* Must match the skeleton. */
+#define EOB_ACT_CONTINUE_SCAN 0
+#define EOB_ACT_END_OF_FILE 1
+#define EOB_ACT_LAST_MATCH 2
+
+#define YY_END_OF_BUFFER_CHAR 0
+
+#define current_buffer(rt) (*(rt)->buffer_stack \
+			    ? (*(rt)->buffer_stack)[*(rt)->buffer_stack_top] \
+			    : NULL)
+#define current_buffer_lvalue(rt) ((*(rt)->buffer_stack)[*(rt)->buffer_stack_top])
+
+static void fatal (struct flexrt_scanner *rt, const char *msg)
+{
+	rt->ops->fatal_error (msg, rt->yyscanner);
+}
+
+static int initial_buf_size (struct flexrt_scanner *rt)
+{
+	return rt->buffer_policy && rt->buffer_policy->yy_initial_size > 0 ?
+		rt->buffer_policy->yy_initial_size : rt->ops->buf_size;
+}
+
+void flexrt_restart (struct flexrt_scanner *rt, FILE *input_file)
+{
+	if (current_buffer (rt) == NULL) {
+		flexrt_ensure_buffer_stack (rt);
+		current_buffer_lvalue (rt) =
+			flexrt_create_buffer (rt, *rt->in, initial_buf_size (rt));
+	}
+
+	flexrt_init_buffer (rt, current_buffer_lvalue (rt), input_file);
+	flexrt_load_buffer_state (rt);
+
+	*rt->did_buffer_switch_on_eof = 1;
+}
+
+void flexrt_switch_to_buffer (struct flexrt_scanner *rt,
+			      struct yy_buffer_state *new_buffer)
+{
+	flexrt_ensure_buffer_stack (rt);
+	if (current_buffer (rt) == new_buffer)
+		return;
+
+	if (current_buffer (rt)) {
+		/* Flush out information for old buffer. */
+		**rt->c_buf_p = *rt->hold_char;
+		current_buffer_lvalue (rt)->yy_buf_pos = *rt->c_buf_p;
+		current_buffer_lvalue (rt)->yy_n_chars = *rt->n_chars;
+	}
+
+	current_buffer_lvalue (rt) = new_buffer;
+	flexrt_load_buffer_state (rt);
+
+	*rt->did_buffer_switch_on_eof = 1;
+}
+
+void flexrt_load_buffer_state (struct flexrt_scanner *rt)
+{
+	struct yy_buffer_state *b = current_buffer_lvalue (rt);
+
+	*rt->n_chars = b->yy_n_chars;
+	*rt->text_ptr = *rt->c_buf_p = b->yy_buf_pos;
+	*rt->in = b->yy_input_file;
+	*rt->hold_char = **rt->c_buf_p;
+}
+
+struct yy_buffer_state *flexrt_create_buffer (struct flexrt_scanner *rt,
+					      FILE *file, int size)
+{
+	struct yy_buffer_state *b;
+
+	b = (struct yy_buffer_state *) rt->ops->allocate (sizeof (struct yy_buffer_state),
+							 rt->yyscanner);
+	if (b == NULL)
+		fatal (rt, "out of dynamic memory in yy_create_buffer()");
+
+	b->yy_buf_size = size;
+
+	/* yy_ch_buf has to be 2 characters longer than the size given because
+	 * we need to put in 2 end-of-buffer characters.
+	 */
+	b->yy_ch_buf = (char *) rt->ops->allocate ((size_t) (b->yy_buf_size + 2),
+						  rt->yyscanner);
+	if (b->yy_ch_buf == NULL)
+		fatal (rt, "out of dynamic memory in yy_create_buffer()");
+
+	b->yy_is_our_buffer = 1;
+
+	flexrt_init_buffer (rt, b, file);
+
+	return b;
+}
+
+void flexrt_delete_buffer (struct flexrt_scanner *rt,
+			   struct yy_buffer_state *b)
+{
+	if (b == NULL)
+		return;
+
+	if (b == current_buffer (rt))	/* Not sure if we should pop here. */
+		current_buffer_lvalue (rt) = NULL;
+
+	if (b->yy_is_our_buffer)
+		rt->ops->release ((void *) b->yy_ch_buf, rt->yyscanner);
+
+	rt->ops->release ((void *) b, rt->yyscanner);
+}
+
+void flexrt_init_buffer (struct flexrt_scanner *rt,
+			 struct yy_buffer_state *b, FILE *file)
+{
+	int     oerrno = errno;
+
+	flexrt_flush_buffer (rt, b);
+
+	b->yy_input_file = file;
+	b->yy_fill_buffer = b->yy_input_file != NULL;
+
+	/* If b is the current buffer, then this was _probably_ called
+	 * from yyrestart() or through yy_get_next_buffer.  In that case,
+	 * we don't want to reset the lineno or column.
+	 */
+	if (b != current_buffer (rt)) {
+		b->yy_bs_lineno = 1;
+		b->yy_bs_column = 0;
+	}
+
+	if (rt->ops->interactive >= 0)
+		b->yy_is_interactive = rt->ops->interactive;
+	else
+		b->yy_is_interactive = file ? (isatty (fileno (file)) > 0) : 0;
+
+	errno = oerrno;
+}
+
+void flexrt_flush_buffer (struct flexrt_scanner *rt,
+			  struct yy_buffer_state *b)
+{
+	if (b == NULL)
+		return;
+
+	b->yy_n_chars = 0;
+
+	/* We always need two end-of-buffer characters.  The first causes
+	 * a transition to the end-of-buffer state.  The second causes
+	 * a jam in that state.
+	 */
+	b->yy_ch_buf[0] = YY_END_OF_BUFFER_CHAR;
+	b->yy_ch_buf[1] = YY_END_OF_BUFFER_CHAR;
+
+	b->yy_buf_pos = &b->yy_ch_buf[0];
+
+	b->yyatbol = 1;
+	b->yy_buffer_status = YY_BUFFER_NEW;
+
+	if (b == current_buffer (rt))
+		flexrt_load_buffer_state (rt);
+}
+
+void flexrt_push_buffer_state (struct flexrt_scanner *rt,
+			       struct yy_buffer_state *new_buffer)
+{
+	if (new_buffer == NULL)
+		return;
+
+	flexrt_ensure_buffer_stack (rt);
+
+	if (current_buffer (rt) != NULL) {
+		/* Flush out information for old buffer. */
+		**rt->c_buf_p = *rt->hold_char;
+		current_buffer_lvalue (rt)->yy_buf_pos = *rt->c_buf_p;
+		current_buffer_lvalue (rt)->yy_n_chars = *rt->n_chars;
+
+		/* Only push if top exists. Otherwise, replace top. */
+		++*rt->buffer_stack_top;
+	}
+	current_buffer_lvalue (rt) = new_buffer;
+
+	flexrt_load_buffer_state (rt);
+	*rt->did_buffer_switch_on_eof = 1;
+}
+
+void flexrt_pop_buffer_state (struct flexrt_scanner *rt)
+{
+	if (current_buffer (rt) == NULL)
+		return;
+
+	flexrt_delete_buffer (rt, current_buffer (rt));
+	current_buffer_lvalue (rt) = NULL;
+	if (*rt->buffer_stack_top > 0)
+		--*rt->buffer_stack_top;
+
+	if (current_buffer (rt) != NULL) {
+		flexrt_load_buffer_state (rt);
+		*rt->did_buffer_switch_on_eof = 1;
+	}
+}
+
+void flexrt_ensure_buffer_stack (struct flexrt_scanner *rt)
+{
+	size_t  num_to_alloc;
+
+	if (*rt->buffer_stack == NULL) {
+		/* Most scanners never push; start with room for one buffer. */
+		num_to_alloc = 1;
+		*rt->buffer_stack = (struct yy_buffer_state **)
+			rt->ops->allocate (num_to_alloc * sizeof (struct yy_buffer_state *),
+					  rt->yyscanner);
+		if (*rt->buffer_stack == NULL)
+			fatal (rt, "out of dynamic memory in yyensure_buffer_stack()");
+
+		memset (*rt->buffer_stack, 0,
+			num_to_alloc * sizeof (struct yy_buffer_state *));
+
+		*rt->buffer_stack_max = num_to_alloc;
+		*rt->buffer_stack_top = 0;
+		return;
+	}
+
+	if (*rt->buffer_stack_top >= *rt->buffer_stack_max - 1) {
+		/* Increase the buffer to prepare for a possible push. */
+		size_t  grow_size = 8 /* arbitrary grow size */ ;
+
+		num_to_alloc = *rt->buffer_stack_max + grow_size;
+		*rt->buffer_stack = (struct yy_buffer_state **)
+			rt->ops->reallocate (*rt->buffer_stack,
+					    num_to_alloc * sizeof (struct yy_buffer_state *),
+					    rt->yyscanner);
+		if (*rt->buffer_stack == NULL)
+			fatal (rt, "out of dynamic memory in yyensure_buffer_stack()");
+
+		/* zero only the new slots. */
+		memset (*rt->buffer_stack + *rt->buffer_stack_max, 0,
+			grow_size * sizeof (struct yy_buffer_state *));
+		*rt->buffer_stack_max = num_to_alloc;
+	}
+}
+
+struct yy_buffer_state *flexrt_scan_buffer (struct flexrt_scanner *rt,
+					    char *base, size_t size)
+{
+	struct yy_buffer_state *b;
+
+	if (size < 2 ||
+	    base[size - 2] != YY_END_OF_BUFFER_CHAR ||
+	    base[size - 1] != YY_END_OF_BUFFER_CHAR)
+		/* They forgot to leave room for the EOB's. */
+		return NULL;
+
+	b = (struct yy_buffer_state *) rt->ops->allocate (sizeof (struct yy_buffer_state),
+							 rt->yyscanner);
+	if (b == NULL)
+		fatal (rt, "out of dynamic memory in yy_scan_buffer()");
+
+	b->yy_buf_size = (int) (size - 2);	/* "- 2" to take care of EOB's */
+	b->yy_buf_pos = b->yy_ch_buf = base;
+	b->yy_is_our_buffer = 0;
+	b->yy_input_file = NULL;
+	b->yy_n_chars = b->yy_buf_size;
+	b->yy_is_interactive = 0;
+	b->yyatbol = 1;
+	b->yy_fill_buffer = 0;
+	b->yy_buffer_status = YY_BUFFER_NEW;
+
+	flexrt_switch_to_buffer (rt, b);
+
+	return b;
+}
+
+struct yy_buffer_state *flexrt_scan_bytes (struct flexrt_scanner *rt,
+					   const char *bytes, int len)
+{
+	struct yy_buffer_state *b;
+	char   *buf;
+	size_t  n;
+
+	/* Get memory for full buffer, including space for trailing EOB's. */
+	n = (size_t) (len + 2);
+	buf = (char *) rt->ops->allocate (n, rt->yyscanner);
+	if (buf == NULL)
+		fatal (rt, "out of dynamic memory in yy_scan_bytes()");
+
+	memcpy (buf, bytes, (size_t) len);
+	buf[len] = buf[len + 1] = YY_END_OF_BUFFER_CHAR;
+
+	b = flexrt_scan_buffer (rt, buf, n);
+	if (b == NULL)
+		fatal (rt, "bad buffer in yy_scan_bytes()");
+
+	/* It's okay to grow etc. this buffer, and we should throw it
+	 * away when we're done.
+	 */
+	b->yy_is_our_buffer = 1;
+
+	return b;
+}
+
+/* flexrt_get_next_buffer - try to read in a new buffer
+ *
+ * Returns a code representing an action:
+ *	EOB_ACT_LAST_MATCH -
+ *	EOB_ACT_CONTINUE_SCAN - continue scanning from current position
+ *	EOB_ACT_END_OF_FILE - end of file
+ */
+int flexrt_get_next_buffer (struct flexrt_scanner *rt)
+{
+	struct yy_buffer_state *b = current_buffer_lvalue (rt);
+	int     more_adj = rt->more_len ? *rt->more_len : 0;
+	int     number_to_move;
+	int     ret_val;
+
+	if (*rt->c_buf_p > &b->yy_ch_buf[*rt->n_chars + 1])
+		fatal (rt, "fatal flex scanner internal error--end of buffer missed");
+
+	if (b->yy_fill_buffer == 0) {
+		/* Don't try to fill the buffer, so this is an EOF.  If we
+		 * matched a single character, the EOB, treat this as a
+		 * final EOF; otherwise process the text before it first.
+		 */
+		if (*rt->c_buf_p - *rt->text_ptr - more_adj == 1)
+			return EOB_ACT_END_OF_FILE;
+		else
+			return EOB_ACT_LAST_MATCH;
+	}
+
+	/* Try to read more data. */
+
+	/* First move last chars to start of buffer. */
+	number_to_move = (int) (*rt->c_buf_p - *rt->text_ptr - 1);
+	memmove (b->yy_ch_buf, *rt->text_ptr, (size_t) number_to_move);
+
+	if (b->yy_is_our_buffer && rt->buffer_policy) {
+		/* Give back what a long token made the buffer grow to. */
+		int     new_size = rt->buffer_policy->yy_shrink_size;
+
+		if (number_to_move == 0 && rt->buffer_policy->yy_release_idle)
+			new_size = initial_buf_size (rt);
+		if (new_size > 0 && new_size < 2 * number_to_move + 2)
+			new_size = 2 * number_to_move + 2;
+
+		/* Only bother when it at least halves the buffer. */
+		if (new_size > 0 && new_size <= b->yy_buf_size / 2) {
+			char   *new_buf = (char *) rt->ops->reallocate ((void *) b->yy_ch_buf,
+									(size_t) (new_size + 2),
+									rt->yyscanner);
+
+			if (new_buf) {
+				b->yy_ch_buf = new_buf;
+				b->yy_buf_size = new_size;
+				*rt->c_buf_p = &b->yy_ch_buf[number_to_move + 1];
+			}
+		}
+	}
+
+	if (b->yy_buffer_status == YY_BUFFER_EOF_PENDING)
+		/* don't do the read, it's not guaranteed to return an EOF,
+		 * just force an EOF
+		 */
+		b->yy_n_chars = *rt->n_chars = 0;
+
+	else {
+		int     num_to_read = b->yy_buf_size - number_to_move - 1;
+
+		while (num_to_read <= 0) {	/* Not enough room in the buffer - grow it. */
+			int     yy_c_buf_p_offset = (int) (*rt->c_buf_p - b->yy_ch_buf);
+
+			if (b->yy_is_our_buffer) {
+				int     new_size = b->yy_buf_size * 2;
+
+				if (new_size <= 0)
+					b->yy_buf_size += b->yy_buf_size / 8;
+				else
+					b->yy_buf_size *= 2;
+
+				/* Include room in for 2 EOB chars. */
+				b->yy_ch_buf = (char *) rt->ops->reallocate ((void *) b->yy_ch_buf,
+									    (size_t) (b->yy_buf_size + 2),
+									    rt->yyscanner);
+			}
+			else
+				/* Can't grow it, we don't own it. */
+				b->yy_ch_buf = NULL;
+
+			if (!b->yy_ch_buf)
+				fatal (rt, "fatal error - scanner input buffer overflow");
+
+			*rt->c_buf_p = &b->yy_ch_buf[yy_c_buf_p_offset];
+
+			num_to_read = b->yy_buf_size - number_to_move - 1;
+		}
+
+		if (num_to_read > rt->ops->read_buf_size)
+			num_to_read = rt->ops->read_buf_size;
+
+		/* Read in more data. */
+		*rt->n_chars = rt->ops->read_input (&b->yy_ch_buf[number_to_move],
+						  num_to_read, rt->yyscanner);
+
+		b->yy_n_chars = *rt->n_chars;
+	}
+
+	if (*rt->n_chars == 0) {
+		if (number_to_move == more_adj) {
+			ret_val = EOB_ACT_END_OF_FILE;
+			flexrt_restart (rt, *rt->in);
+		}
+		else {
+			ret_val = EOB_ACT_LAST_MATCH;
+			b->yy_buffer_status = YY_BUFFER_EOF_PENDING;
+		}
+	}
+	else
+		ret_val = EOB_ACT_CONTINUE_SCAN;
+
+	b = current_buffer_lvalue (rt);
+	if (*rt->n_chars + number_to_move > b->yy_buf_size) {
+		/* Extend the array by 50%, plus the number we really need. */
+		int     new_size = *rt->n_chars + number_to_move + (*rt->n_chars >> 1);
+
+		b->yy_ch_buf = (char *) rt->ops->reallocate ((void *) b->yy_ch_buf,
+							    (size_t) new_size, rt->yyscanner);
+		if (!b->yy_ch_buf)
+			fatal (rt, "out of dynamic memory in yy_get_next_buffer()");
+
+		/* "- 2" to take care of EOB's */
+		b->yy_buf_size = new_size - 2;
+	}
+
+	*rt->n_chars += number_to_move;
+	b->yy_ch_buf[*rt->n_chars] = YY_END_OF_BUFFER_CHAR;
+	b->yy_ch_buf[*rt->n_chars + 1] = YY_END_OF_BUFFER_CHAR;
+
+	*rt->text_ptr = &b->yy_ch_buf[0];
+
+	return ret_val;
+}
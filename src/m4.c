@@ -0,0 +1,569 @@
+/* m4.c - built-in expansion of the m4 macros in flex's output */
+
+/*  This file is part of flex. */
+
+/*  Redistribution and use in source and binary forms, with or without */
+/*  modification, are permitted provided that the following conditions */
+/*  are met: */
+
+/*  1. Redistributions of source code must retain the above copyright */
+/*     notice, this list of conditions and the following disclaimer. */
+/*  2. Redistributions in binary form must reproduce the above copyright */
+/*     notice, this list of conditions and the following disclaimer in the */
+/*     documentation and/or other materials provided with the distribution. */
+
+/*  Neither the name of the University nor the names of its contributors */
+/*  may be used to endorse or promote products derived from this software */
+/*  without specific prior written permission. */
+
+/*  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR */
+/*  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR */
+/*  PURPOSE. */
+
+#include "flexdef.h"
+
+/* The skeletons and the code flex writes around them use only a handful
+ * of m4's builtins, as "m4 -P" names them: m4_define, m4_undefine,
+ * m4_ifdef, m4_ifelse, m4_dnl, m4_changequote and m4_changecom.  This
+ * expands them the way GNU m4 does -- same tokens, same argument
+ * collection, same rescanning of expansions -- so that the scanner comes
+ * out byte for byte as it would from m4, without starting one.  It also
+ * gives m4's warnings about the number of arguments to m4_ifelse.  Any
+ * other m4_ name is copied through unexpanded.
+ */
+
+/* A growable string. */
+struct str {
+	char   *s;
+	size_t  len, max;
+};
+
+static void str_grow (struct str *b, size_t n)
+{
+	if (b->len + n > b->max) {
+		b->max = b->max ? 2 * b->max : 64;
+		while (b->len + n > b->max)
+			b->max *= 2;
+		b->s = realloc (b->s, b->max);
+		if (!b->s)
+			flexfatal (_("memory allocation failed in m4_expand()"));
+	}
+}
+
+static void str_add (struct str *b, const char *p, size_t n)
+{
+	str_grow (b, n);
+	memcpy (b->s + b->len, p, n);
+	b->len += n;
+}
+
+static void str_addc (struct str *b, int c)
+{
+	str_grow (b, 1);
+	b->s[b->len++] = (char) c;
+}
+
+/* Returns b's contents as a NUL-terminated string. */
+static char *str_cstr (struct str *b)
+{
+	str_addc (b, '\0');
+	b->len--;
+	return b->s;
+}
+
+/* Input is a stack of texts: the macro expansion being rescanned is on
+ * top of whatever follows the call.  Reading runs on from one to the next,
+ * as it does in m4, so a word or a quote can start in an expansion and
+ * end after it.
+ */
+struct source {
+	char   *own;		/* freed when the source is used up */
+	const char *p, *end;
+};
+
+static struct source *in;
+static int in_top = -1, in_max = 0;
+
+static void push_source (char *own, const char *p, size_t len)
+{
+	if (len == 0) {
+		free (own);
+		return;
+	}
+	if (++in_top == in_max) {
+		in_max = in_max ? 2 * in_max : 32;
+		in = realloc (in, (size_t) in_max * sizeof (*in));
+		if (!in)
+			flexfatal (_("memory allocation failed in m4_expand()"));
+	}
+	in[in_top].own = own;
+	in[in_top].p = p;
+	in[in_top].end = p + len;
+}
+
+static int next_char (void)
+{
+	while (in_top >= 0 && in[in_top].p == in[in_top].end) {
+		free (in[in_top].own);
+		--in_top;
+	}
+	if (in_top < 0)
+		return EOF;
+	return (unsigned char) *in[in_top].p++;
+}
+
+static int peek_char (void)
+{
+	int     i;
+
+	for (i = in_top; i >= 0; --i)
+		if (in[i].p != in[i].end)
+			return (unsigned char) *in[i].p;
+	return EOF;
+}
+
+/* Having read c, consumes the rest of s and returns true if c starts
+ * s; otherwise consumes nothing more.
+ */
+static bool match (int c, const char *s)
+{
+	const char *q;
+	int     i, n;
+
+	if (s[0] == '\0' || c != (unsigned char) s[0])
+		return false;
+	q = s + 1;
+	for (i = in_top; *q && i >= 0; --i) {
+		const char *p = in[i].p;
+
+		while (*q && p != in[i].end)
+			if (*p++ != *q++)
+				return false;
+	}
+	if (*q)
+		return false;
+	for (n = (int) strlen (s) - 1; n > 0; --n)
+		next_char ();
+	return true;
+}
+
+/* Macros.  A builtin has no text, only a number. */
+enum builtin {
+	USER_MACRO, BI_DEFINE, BI_UNDEFINE, BI_IFDEF, BI_IFELSE, BI_DNL,
+	BI_CHANGEQUOTE, BI_CHANGECOM
+};
+
+struct macro {
+	char   *name, *text;
+	enum builtin which;
+	struct macro *next;
+};
+
+#define MACRO_HASH_SIZE 1021
+static struct macro *macros[MACRO_HASH_SIZE];
+
+static struct macro **find_macro (const char *name)
+{
+	struct macro **m;
+	unsigned int h = 0;
+	const char *p;
+
+	for (p = name; *p; ++p)
+		h = h * 31 + (unsigned char) *p;
+	for (m = &macros[h % MACRO_HASH_SIZE]; *m; m = &(*m)->next)
+		if (strcmp ((*m)->name, name) == 0)
+			break;
+	return m;
+}
+
+static void define_macro (const char *name, const char *text,
+			  enum builtin which)
+{
+	struct macro **m = find_macro (name);
+
+	if (*m == NULL) {
+		*m = calloc (1, sizeof (**m));
+		if (!*m)
+			flexfatal (_("memory allocation failed in m4_expand()"));
+		(*m)->name = xstrdup (name);
+	}
+	else
+		free ((*m)->text);
+	(*m)->text = text ? xstrdup (text) : NULL;
+	(*m)->which = which;
+}
+
+static void undefine_macro (const char *name)
+{
+	struct macro **m = find_macro (name), *dead = *m;
+
+	if (dead) {
+		*m = dead->next;
+		free (dead->name);
+		free (dead->text);
+		free (dead);
+	}
+}
+
+/* The current quotes and comment delimiters; an empty start turns them
+ * off.
+ */
+static char lquote[MAXLINE], rquote[MAXLINE], bcomm[MAXLINE], ecomm[MAXLINE];
+
+static void set_delims (char *start, char *end, const char *s,
+			const char *e)
+{
+	strncpy (start, s, MAXLINE - 1);
+	start[MAXLINE - 1] = '\0';
+	strncpy (end, e, MAXLINE - 1);
+	end[MAXLINE - 1] = '\0';
+}
+
+enum token {
+	TOK_EOF, TOK_WORD, TOK_STRING, TOK_OTHER
+};
+
+/* Reads a token into t: a comment or a single character (TOK_OTHER), a
+ * word, or a quoted string with its outermost quotes removed.
+ */
+static enum token next_token (struct str *t)
+{
+	int     c, depth;
+
+	t->len = 0;
+	if ((c = next_char ()) == EOF)
+		return TOK_EOF;
+
+	if (match (c, bcomm)) {
+		str_add (t, bcomm, strlen (bcomm));
+		for (;;) {
+			if ((c = next_char ()) == EOF)
+				flexerror (_("m4: end of file in comment"));
+			if (match (c, ecomm))
+				break;
+			str_addc (t, c);
+		}
+		str_add (t, ecomm, strlen (ecomm));
+		return TOK_OTHER;
+	}
+
+	if (isalpha (c) || c == '_') {
+		str_addc (t, c);
+		while ((c = peek_char ()) != EOF && (isalnum (c) || c == '_'))
+			str_addc (t, next_char ());
+		return TOK_WORD;
+	}
+
+	if (!match (c, lquote)) {
+		str_addc (t, c);
+		return TOK_OTHER;
+	}
+
+	for (depth = 1;;) {
+		if ((c = next_char ()) == EOF)
+			flexerror (_("m4: end of file in string"));
+		if (match (c, rquote)) {
+			if (--depth == 0)
+				break;
+			str_add (t, rquote, strlen (rquote));
+		}
+		else if (match (c, lquote)) {
+			++depth;
+			str_add (t, lquote, strlen (lquote));
+		}
+		else
+			str_addc (t, c);
+	}
+	return TOK_STRING;
+}
+
+/* A macro call's arguments; argv[0] is the macro's name. */
+struct args {
+	struct str *argv;
+	int     argc, max;
+};
+
+static void expand_word (const char *word, struct str *out);
+
+/* Reads one argument into arg, expanding any macros in it.  Returns true
+ * if more arguments follow.
+ */
+static bool collect_arg (struct str *arg)
+{
+	struct str t = { NULL, 0, 0 };
+	enum token tok;
+	int     depth = 0;
+	bool    more;
+
+	do
+		tok = next_token (&t);
+	while (tok == TOK_OTHER && t.len == 1 && isspace ((unsigned char) t.s[0]));
+
+	for (;; tok = next_token (&t)) {
+		if (tok == TOK_EOF)
+			flexerror (_("m4: end of file in argument list"));
+		if (tok == TOK_WORD) {
+			expand_word (str_cstr (&t), arg);
+			continue;
+		}
+		if (tok == TOK_OTHER && t.len == 1) {
+			if (depth == 0 && (t.s[0] == ',' || t.s[0] == ')')) {
+				more = t.s[0] == ',';
+				break;
+			}
+			if (t.s[0] == '(')
+				++depth;
+			else if (t.s[0] == ')')
+				--depth;
+		}
+		str_add (arg, t.s, t.len);
+	}
+	free (t.s);
+	return more;
+}
+
+static void collect_args (struct args *a)
+{
+	bool    more;
+
+	do {
+		if (a->argc == a->max) {
+			a->max *= 2;
+			a->argv = realloc (a->argv,
+					   (size_t) a->max * sizeof (*a->argv));
+			if (!a->argv)
+				flexfatal (_("memory allocation failed in m4_expand()"));
+		}
+		memset (&a->argv[a->argc], 0, sizeof (*a->argv));
+		more = collect_arg (&a->argv[a->argc++]);
+	} while (more);
+}
+
+static const char *arg (struct args *a, int i)
+{
+	return i < a->argc ? str_cstr (&a->argv[i]) : "";
+}
+
+/* Warns about a call to the builtin a, which m4 expands all the same. */
+static void m4_warning (const char *msg, struct args *a)
+{
+	char    warning[MAXLINE];
+
+	snprintf (warning, sizeof (warning), msg, arg (a, 0));
+	fprintf (stderr, "%s: m4: warning, %s\n", program_name, warning);
+}
+
+/* Substitutes a call's arguments for the $1, $#, $@ and so on in a
+ * macro's text.
+ */
+static void expand_user (const char *text, struct args *a, struct str *r)
+{
+	const char *p;
+	int     i, n;
+
+	for (p = text; *p; ++p) {
+		if (*p != '$' || !p[1] || !strchr ("0123456789#*@", p[1])) {
+			str_addc (r, *p);
+			continue;
+		}
+		++p;
+		if (isdigit ((unsigned char) *p)) {
+			for (n = 0; isdigit ((unsigned char) *p); ++p)
+				n = n * 10 + (*p - '0');
+			--p;
+			str_add (r, arg (a, n), strlen (arg (a, n)));
+		}
+		else if (*p == '#') {
+			char    num[16];
+
+			snprintf (num, sizeof (num), "%d", a->argc - 1);
+			str_add (r, num, strlen (num));
+		}
+		else
+			for (i = 1; i < a->argc; ++i) {
+				if (i > 1)
+					str_addc (r, ',');
+				if (*p == '@')
+					str_add (r, lquote, strlen (lquote));
+				str_add (r, arg (a, i), strlen (arg (a, i)));
+				if (*p == '@')
+					str_add (r, rquote, strlen (rquote));
+			}
+	}
+}
+
+/* Runs a builtin, leaving any text it expands to in r. */
+static void expand_builtin (enum builtin which, struct args *a,
+			    struct str *r)
+{
+	int     i, n;
+
+	switch (which) {
+	case BI_DEFINE:
+		if (a->argc > 1)
+			define_macro (arg (a, 1), arg (a, 2), USER_MACRO);
+		break;
+
+	case BI_UNDEFINE:
+		for (i = 1; i < a->argc; ++i)
+			undefine_macro (arg (a, i));
+		break;
+
+	case BI_IFDEF:
+		i = *find_macro (arg (a, 1)) ? 2 : 3;
+		str_add (r, arg (a, i), strlen (arg (a, i)));
+		break;
+
+	case BI_IFELSE:
+		/* As in m4, one argument is a comment, two are too few, and
+		 * the last of 5, 8, 11... is ignored.
+		 */
+		n = a->argc - 1;
+		if (n == 2)
+			m4_warning (_("too few arguments to builtin `%s'"), a);
+		else if (n >= 5 && n % 3 == 2)
+			m4_warning (_("excess arguments to builtin `%s' ignored"), a);
+		for (i = 1; n >= 3;) {
+			if (strcmp (arg (a, i), arg (a, i + 1)) == 0) {
+				str_add (r, arg (a, i + 2),
+					 strlen (arg (a, i + 2)));
+				break;
+			}
+			if (n == 4 || n == 5) {
+				str_add (r, arg (a, i + 3),
+					 strlen (arg (a, i + 3)));
+				break;
+			}
+			if (n == 3)
+				break;
+			i += 3;
+			n -= 3;
+		}
+		break;
+
+	case BI_DNL:
+		while ((i = next_char ()) != EOF && i != '\n') ;
+		break;
+
+	case BI_CHANGEQUOTE:
+		if (a->argc == 1)
+			set_delims (lquote, rquote, "`", "'");
+		else
+			set_delims (lquote, rquote, arg (a, 1),
+				    a->argc > 2 ? arg (a, 2) : "'");
+		break;
+
+	case BI_CHANGECOM:
+		if (a->argc == 1)
+			set_delims (bcomm, ecomm, "", "");
+		else
+			set_delims (bcomm, ecomm, arg (a, 1),
+				    a->argc > 2 ? arg (a, 2) : "\n");
+		break;
+
+	case USER_MACRO:
+		break;
+	}
+}
+
+/* Expands word if it names a macro, leaving its expansion to be read
+ * again; otherwise adds it to out.
+ */
+static void expand_word (const char *word, struct str *out)
+{
+	struct macro *m = *find_macro (word);
+	struct args a;
+	struct str r = { NULL, 0, 0 };
+	enum builtin which;
+	char   *text;
+	int     i;
+
+	if (m == NULL
+	    || (peek_char () != '(' && m->which != USER_MACRO
+		&& m->which != BI_DNL && m->which != BI_CHANGEQUOTE
+		&& m->which != BI_CHANGECOM)) {
+		/* m4_define and friends are only builtins with arguments. */
+		str_add (out, word, strlen (word));
+		return;
+	}
+
+	/* The arguments may redefine the macro. */
+	which = m->which;
+	text = m->text ? xstrdup (m->text) : NULL;
+
+	a.max = 8;
+	a.argc = 1;
+	a.argv = calloc ((size_t) a.max, sizeof (*a.argv));
+	if (!a.argv)
+		flexfatal (_("memory allocation failed in m4_expand()"));
+	str_add (&a.argv[0], word, strlen (word));
+	if (peek_char () == '(') {
+		next_char ();
+		collect_args (&a);
+	}
+
+	if (which == USER_MACRO)
+		expand_user (text, &a, &r);
+	else
+		expand_builtin (which, &a, &r);
+	free (text);
+
+	for (i = 0; i < a.argc; ++i)
+		free (a.argv[i].s);
+	free (a.argv);
+	push_source (r.s, r.s, r.len);
+}
+
+/* m4_expand - expand the m4 macros in text as "m4 -P" would
+ *
+ * Returns the expansion, which the caller frees, and its length in
+ * *outlen.
+ */
+char   *m4_expand (const char *text, size_t len, size_t *outlen)
+{
+	struct str out = { NULL, 0, 0 }, t = { NULL, 0, 0 };
+	enum token tok;
+	int     i;
+
+	for (i = 0; i < MACRO_HASH_SIZE; ++i)
+		while (macros[i])
+			undefine_macro (macros[i]->name);
+	define_macro ("m4_define", NULL, BI_DEFINE);
+	define_macro ("m4_undefine", NULL, BI_UNDEFINE);
+	define_macro ("m4_ifdef", NULL, BI_IFDEF);
+	define_macro ("m4_ifelse", NULL, BI_IFELSE);
+	define_macro ("m4_dnl", NULL, BI_DNL);
+	define_macro ("m4_changequote", NULL, BI_CHANGEQUOTE);
+	define_macro ("m4_changecom", NULL, BI_CHANGECOM);
+	set_delims (lquote, rquote, "`", "'");
+	set_delims (bcomm, ecomm, "#", "\n");
+
+	str_grow (&out, len + len / 4);
+	push_source (NULL, text, len);
+	for (;;) {
+		/* Most of the text is neither words nor quotes, and goes
+		 * straight through.
+		 */
+		if (in_top >= 0) {
+			const char *p = in[in_top].p;
+
+			while (p != in[in_top].end && !isalpha ((unsigned char) *p)
+			       && *p != '_' && *p != lquote[0] && *p != bcomm[0])
+				++p;
+			str_add (&out, in[in_top].p, (size_t) (p - in[in_top].p));
+			in[in_top].p = p;
+		}
+
+		if ((tok = next_token (&t)) == TOK_EOF)
+			break;
+		if (tok == TOK_WORD)
+			expand_word (str_cstr (&t), &out);
+		else
+			str_add (&out, t.s, t.len);
+	}
+	free (t.s);
+
+	*outlen = out.len;
+	return str_cstr (&out);
+}
@@ -43,12 +43,14 @@ static char flex_version[] = FLEX_VERSION;
 /* declare functions that have forward references */
 
 void flexinit(int, char **);
+static void cache_outputs(void);
 void readin(void);
 void set_up_initial_allocations(void);
 
 /* these globals are all defined and commented in flexdef.h */
 int     syntaxerror, eofseen;
 int     yymore_used, reject, real_reject, continued_action, in_rule;
+int     chunked_rule;
 int     datapos, dataline, linenum/*由函数set_input_file初始化，指明行号*/;
 FILE   *skelfile = NULL;
 int     skel_ind = 0;
@@ -63,9 +65,9 @@ int     maximum_mns, current_mns, current_max_rules;
 int     num_rules, num_eof_rules, default_rule, lastnfa;
 int    *firstst, *lastst, *finalst, *transchar, *trans1, *trans2;
 int    *accptnum, *assoc_rule, *state_type;
-int    *rule_type, *rule_linenum, *rule_useful;
+int    *rule_type, *rule_linenum, *rule_useful, *rule_trail;
 int     current_state_type;
-int     variable_trailing_context_rules;
+int     variable_trailing_context_rules, trail_tags;
 int     numtemps, numprots, protprev[MSP], protnext[MSP], prottbl[MSP];
 int     protcomst[MSP], firstprot, lastprot, protsave[PROT_SAVE_SIZE];
 int     numecs, nextecm[CSIZE + 1], ecgroup[CSIZE + 1], nummecs,
@@ -89,13 +91,15 @@ int     sectnum, nummt, hshcol, dfaeql, numeps, eps2, num_reallocs, nmval;
 int     tmpuses, totnst, peakpairs, numuniq, numdup, hshsave;
 int     num_backing_up, bol_needed;
 int     end_of_buffer_state;
+int    *dfa_nxt, *dense_row, num_dense_rows;
 char  **input_files;/*输入的解析文件数组*/
 int     num_input_files;/*有多少个输入文件*/
 jmp_buf flex_main_jmp_buf;
-bool   *rule_has_nl, *ccl_has_nl;
+bool   *rule_has_nl, *rule_skip, *rule_chunked, *rule_echo, *ccl_has_nl;
+int     num_skip_rules, num_chunked_rules;
 int     nlch = '\n';
 
-bool    tablesext, tablesverify, gentables;
+bool    tablesext, tablesverify, tablesembed, tablestrail, gentables;
 char   *tablesfilename=0,*tablesname=0;
 struct yytbl_writer tableswr;
 size_t footprint;
@@ -117,6 +121,7 @@ extern FILE* yyout;
 
 static char outfile_path[MAXLINE];
 static int outfile_created = 0;
+static int job_child = 0; /* set in a process started by run_jobs() */
 static int _stdout_closed = 0; /* flag to prevent double-fclose() on stdout. */
 const char *escaped_qstart = "]]M4_YY_NOOP[M4_YY_NOOP[M4_YY_NOOP[[";
 const char *escaped_qend   = "]]M4_YY_NOOP]M4_YY_NOOP]M4_YY_NOOP[[";
@@ -156,6 +161,11 @@ int flex_main (int argc, char *argv[])
 
 			}
 		}
+		/* The output is complete once the filters have exited. */
+		if (exit_status == 1 && env.cache_dir)
+			cache_outputs ();
+		if (env.cache_dir)
+			cache_finish ();
 		return exit_status - 1;/*确定退出码*/
 	}
 
@@ -164,17 +174,23 @@ int flex_main (int argc, char *argv[])
 	readin ();
 
 	skelout (true);		/* %% [1.0] DFA */
-	footprint += ntod ();
 
-	for (i = 1; i <= num_rules; ++i)
-		if (!rule_useful[i] && i != default_rule)
-			line_warning (_("rule cannot be matched"),
-				      rule_linenum[i]);
-
-	if (ctrl.spprdflt && !reject && rule_useful[default_rule])
-		line_warning (_
-			      ("-s option given but default rule can be matched"),
-			      rule_linenum[default_rule]);
+	/* A lazy DFA is built by the scanner as it runs, so we never
+	 * learn which rules can be matched.
+	 */
+	if (!ctrl.lazy_dfa) {
+		footprint += ntod ();
+
+		for (i = 1; i <= num_rules; ++i)
+			if (!rule_useful[i] && i != default_rule)
+				line_warning (_("rule cannot be matched"),
+					      rule_linenum[i]);
+
+		if (ctrl.spprdflt && !reject && rule_useful[default_rule])
+			line_warning (_
+				      ("-s option given but default rule can be matched"),
+				      rule_linenum[default_rule]);
+	}
 
 	comment("START of m4 controls\n");
 
@@ -267,6 +283,9 @@ int flex_main (int argc, char *argv[])
 	/* Note, flexend does not return.  It exits with its argument
 	 * as status.
 	 */
+	if (tablestrail)
+		gentrailfile ();
+
 	flexend (0);
 
 	return 0;		/* keep compilers/lint happy */
@@ -294,8 +313,16 @@ void initialize_output_filters(void)
 {
 	const char * m4 = NULL;
 
+	/* Unless told which m4 to use, or asked for only part of the
+	 * chain, expand the macros without running one.
+	 */
+	if (!(m4 = getenv("M4")) && preproc_level > 2) {
+		filter_expand_begin(env.headerfilename);
+		return;
+	}
+
 	output_chain = filter_create_int(NULL, filter_tee_header, env.headerfilename);
-	if ( !(m4 = getenv("M4"))) {
+	if (!m4) {
 		m4 = M4;
 	}
 	filter_create_ext(output_chain, m4, "-P", 0);
@@ -309,6 +336,164 @@ void initialize_output_filters(void)
 }
 
 
+/* cache_outputs - keep the files this run wrote in the cache */
+static void cache_outputs (void)
+{
+	const char *files[4];
+	int     n = 0;
+
+	if (env.use_stdout)
+		return;
+	files[n++] = env.outfilename;
+	if (env.headerfilename)
+		files[n++] = env.headerfilename;
+	if (tablesext) {
+		if (tableswr.out)
+			fflush (tableswr.out);
+		files[n++] = tablesfilename;
+	}
+	if (env.backing_up_report)
+		files[n++] = backing_name;
+	cache_store (files, n);
+}
+
+/* job_outfile - name a job's scanner after its input file
+ *
+ * "dir/scan.l" becomes "dir/scan.c", or "dir/scan.cc" for C++, whatever
+ * the scanner's prefix.  Returns path.
+ */
+static char *job_outfile (char *path, size_t size, const char *input)
+{
+	const char *base = strrchr (input, '/');
+	const char *dot = strrchr (base ? base : input, '.');
+	int     stem = dot ? (int) (dot - input) : (int) strlen (input);
+
+	snprintf (path, size, "%.*s.%s", stem, input, suffix());
+	if (strcmp (path, input) == 0)
+		lerr (_("-j would write the scanner over its input file %s"), input);
+	return path;
+}
+
+/* check_jobs - refuse jobs that would write over an input or each other */
+static void check_jobs (void)
+{
+	char    name[MAXLINE], other[MAXLINE];
+	int     i, j;
+
+	if (env.did_outfilename || env.use_stdout)
+		flexerror (_("-o and -t cannot be used with -j and several input files"));
+	if (env.headerfilename || tablesext || env.backing_up_report)
+		flexerror (_("--header-file, --tables-file and -b cannot be used with -j and several input files"));
+
+	for (i = 0; i < num_input_files; ++i) {
+		job_outfile (name, sizeof(name), input_files[i]);
+		for (j = 0; j < i; ++j)
+			if (strcmp (name, job_outfile (other, sizeof(other), input_files[j])) == 0)
+				lerr (_("-j would write the scanners of %s and %s to the same file"),
+				      input_files[j], input_files[i]);
+	}
+}
+
+#if HAVE_WORKING_FORK
+/* run_jobs - generate each input file's scanner in a process of its own
+ *
+ * At most env.jobs of them run at once, fewer if no more processes can
+ * be made.  Returns only in a child, with the input files cut down to the
+ * one it is to read; the parent waits for every child and exits, with an
+ * error if any of them failed.
+ */
+static void run_jobs (char **argv, int first_input)
+{
+	int     i, running = 0, failed = 0, child_status;
+	pid_t   pid;
+
+	(void) argv;
+	(void) first_input;
+	check_jobs ();
+
+	for (i = 0; i < num_input_files; ++i) {
+		if (running == env.jobs && wait (&child_status) > 0) {
+			--running;
+			if (!WIFEXITED (child_status)
+			    || WEXITSTATUS (child_status) != 0)
+				failed = 1;
+		}
+
+		fflush (stdout);
+		fflush (stderr);
+		while ((pid = fork ()) == -1) {
+			/* Let a job finish before trying again. */
+			if (running == 0 || wait (&child_status) <= 0)
+				flexerror (_("fork failed"));
+			--running;
+			if (!WIFEXITED (child_status)
+			    || WEXITSTATUS (child_status) != 0)
+				failed = 1;
+		}
+		if (pid == 0) {
+			input_files += i;
+			num_input_files = 1;
+			job_child = 1;
+			return;
+		}
+		++running;
+	}
+
+	while (wait (&child_status) > 0)
+		if (!WIFEXITED (child_status)
+		    || WEXITSTATUS (child_status) != 0)
+			failed = 1;
+
+	FLEX_EXIT (failed);
+}
+#else
+/* shell_quote - append arg to a shell command, quoted */
+static void shell_quote (struct Buf *cmd, const char *arg)
+{
+	buf_strappend (cmd, " '");
+	for (; *arg; ++arg)
+		if (*arg == '\'')
+			buf_strappend (cmd, "'\\''");
+		else
+			buf_strnappend (cmd, arg, 1);
+	buf_strappend (cmd, "'");
+}
+
+/* run_jobs - generate each input file's scanner, one after another
+ *
+ * Without fork(), each job is a flex of its own, run through the shell
+ * with the options of this one and the output file the job would have
+ * chosen.  Exits, with an error if any of them failed.
+ */
+static void run_jobs (char **argv, int first_input)
+{
+	char    name[MAXLINE];
+	int     i, j, failed = 0;
+
+	check_jobs ();
+
+	for (i = 0; i < num_input_files; ++i) {
+		struct Buf cmd;
+
+		buf_init (&cmd, sizeof (char));
+		buf_strappend (&cmd, "exec");
+		for (j = 0; j < first_input; ++j)
+			shell_quote (&cmd, argv[j]);
+		shell_quote (&cmd, "-o");
+		shell_quote (&cmd, job_outfile (name, sizeof(name), input_files[i]));
+		shell_quote (&cmd, input_files[i]);
+
+		fflush (stdout);
+		fflush (stderr);
+		if (system ((char *) cmd.elts) != 0)
+			failed = 1;
+		buf_destroy (&cmd);
+	}
+
+	FLEX_EXIT (failed);
+}
+#endif
+
 /* check_options - check user-specified options */
 
 void check_options (void)
@@ -413,8 +598,11 @@ void check_options (void)
 		FILE   *prev_stdout;
 
 		if (!env.did_outfilename) {
-			snprintf (outfile_path, sizeof(outfile_path), outfile_template,
-				  ctrl.prefix, suffix());
+			if (job_child)
+				job_outfile (outfile_path, sizeof(outfile_path), infilename);
+			else
+				snprintf (outfile_path, sizeof(outfile_path), outfile_template,
+					  ctrl.prefix, suffix());
 
 			env.outfilename = outfile_path;
 		}
@@ -469,10 +657,17 @@ void flexend (int exit_status)
 				env.outfilename);
 	}
 
+	if (exit_status == 0)
+		filter_expand_end ();
 
 	if (env.backing_up_report && ctrl.backing_up_file) {
 		if (num_backing_up == 0)
 			fprintf (ctrl.backing_up_file, _("No backing up.\n"));
+		else if (ctrl.catch_backup)
+			fprintf (ctrl.backing_up_file,
+				 _
+				 ("%d backing up (non-accepting) states before --catch-backup, 0 after.\n"),
+				 num_backing_up);
 		else if (ctrl.fullspd || ctrl.fulltbl)
 			fprintf (ctrl.backing_up_file,
 				 _
@@ -584,6 +779,11 @@ void flexend (int exit_status)
 
 		if (num_backing_up == 0)
 			fprintf (stderr, _("  No backing up\n"));
+		else if (ctrl.catch_backup)
+			fprintf (stderr,
+				 _
+				 ("  %d backing-up (non-accepting) states before --catch-backup, 0 after\n"),
+				 num_backing_up);
 		else if (ctrl.fullspd || ctrl.fulltbl)
 			fprintf (stderr,
 				 _
@@ -693,7 +893,7 @@ void flexinit (int argc, char **argv)
 	memset(&ctrl, '\0', sizeof(ctrl));/*ctrl变量清零*/
 	syntaxerror = false;
 	yymore_used = continued_action = false;
-	in_rule = reject = false;
+	in_rule = reject = chunked_rule = false;
 	ctrl.yymore_really_used = ctrl.reject_really_used = trit_unspecified;
 
 	ctrl.do_main = trit_unspecified;
@@ -704,8 +904,9 @@ void flexinit (int argc, char **argv)
 	ctrl.prefix = "yy";
 	ctrl.rewrite = false;
 	ctrl.yylmax = BUFSIZ;
+	ctrl.stride = 1;
 
-	tablesext = tablesverify = false;
+	tablesext = tablesverify = tablesembed = tablestrail = false;
 	gentables = true;
 	tablesfilename = tablesname = NULL;
 
@@ -771,11 +972,17 @@ void flexinit (int argc, char **argv)
                         backing_name = arg;
 			break;
 
+		    case OPT_CACHE_DIR:
+			env.cache_dir = arg;
+			break;
+
 		    case OPT_DONOTHING:
 			break;
 
 		    case OPT_COMPRESSION:
-			if (!sawcmpflag) {
+			/* A stride on its own keeps the default compression. */
+			/* So does -Ch. */
+			if (!sawcmpflag && (!arg || strspn (arg, "hs0123456789") != strlen (arg))) {
 				ctrl.useecs = false;
 				ctrl.usemecs = false;
 				ctrl.fulltbl = false;
@@ -800,6 +1007,10 @@ void flexinit (int argc, char **argv)
 					ctrl.fulltbl = true;
 					break;
 
+				    case 'h':
+					ctrl.hybrid = true;
+					break;
+
 				    case 'm':
 					ctrl.usemecs = true;
 					break;
@@ -808,6 +1019,15 @@ void flexinit (int argc, char **argv)
 					ctrl.use_read = true;
 					break;
 
+				    case 's':
+					/* -Cs2: the digits say how many
+					 * input bytes each step takes.
+					 */
+					ctrl.stride = 0;
+					while (isdigit ((unsigned char) arg[i + 1]))
+						ctrl.stride = ctrl.stride * 10 + arg[++i] - '0';
+					break;
+
 				    default:
 					lerr (_
 					      ("unknown -C option '%c'"),
@@ -843,10 +1063,22 @@ void flexinit (int argc, char **argv)
 			ctrl.interactive = true;/*指明采用交互式*/
 			break;
 
+		    case OPT_BULK_INPUT:
+			ctrl.bulk_input = true;
+			break;
+
 		    case OPT_CASE_INSENSITIVE:
 			sf_set_case_ins(true);
 			break;
 
+		    case OPT_CATCH_BACKUP:
+			ctrl.catch_backup = true;
+			break;
+
+		    case OPT_LAZY_DFA:
+			ctrl.lazy_dfa = true;
+			break;
+
 		    case OPT_LEX_COMPAT:
 			ctrl.lex_compat = true;
 			break;
@@ -881,6 +1113,25 @@ void flexinit (int argc, char **argv)
 			ctrl.prefix = arg;/*指明前缀*/
 			break;
 
+		    case OPT_PARALLEL:
+			ctrl.parallel = true;
+			break;
+
+		    case OPT_INTERLEAVE:
+			ctrl.interleave = true;
+			break;
+
+		    case OPT_JOBS:
+		    {
+			char   *end;
+			long    n = strtol (arg, &end, 10);
+
+			if (end == arg || *end != '\0' || n < 1 || n > INT_MAX)
+				flexerror (_("-j needs a positive number of jobs"));
+			env.jobs = (int) n;
+			break;
+		    }
+
 		    case OPT_PERF_REPORT:
 			++env.performance_hint;
 			break;
@@ -897,10 +1148,26 @@ void flexinit (int argc, char **argv)
 			ctrl.reentrant = true;
 			break;
 
+		    case OPT_RELEX:
+			ctrl.relex = true;
+			break;
+
 		    case OPT_NO_REENTRANT:
 			ctrl.reentrant = false;
 			break;
 
+		    case OPT_SHARED_RUNTIME:
+			ctrl.shared_runtime = true;
+			break;
+
+		    case OPT_THREAD_LOCAL:
+			ctrl.thread_local = true;
+			break;
+
+		    case OPT_SHUFFLE_DFA:
+			ctrl.shuffle_dfa = true;
+			break;
+
 		    case OPT_SKEL:
 			env.skelname = arg;
 			break;
@@ -930,6 +1197,14 @@ void flexinit (int argc, char **argv)
 			tablesverify = true;
 			break;
 
+		    case OPT_TABLES_TRAIL:
+			tablestrail = true;
+			break;
+
+		    case OPT_TOKEN_BATCH:
+			ctrl.token_batch = true;
+			break;
+
 		    case OPT_TRACE:
 			env.trace = true;
 			break;
@@ -983,6 +1258,10 @@ void flexinit (int argc, char **argv)
 			ctrl.yytext_is_array = false;
 			break;
 
+		    case OPT_ECHO_SPANS:
+			ctrl.echo_spans = true;
+			break;
+
 		    case OPT_ECS:
 			ctrl.useecs = true;
 			break;
@@ -991,6 +1270,11 @@ void flexinit (int argc, char **argv)
 			ctrl.useecs = false;
 			break;
 
+		    case OPT_EMBED_TABLES:
+			tablesext = tablesembed = true;
+			tablesfilename = arg;
+			break;
+
 		    case OPT_EMIT:
 			ctrl.emit = arg;
 			break;
@@ -1148,6 +1432,9 @@ void flexinit (int argc, char **argv)
 		    case OPT_NO_YYSET_LLOC:
 			ctrl.no_yyset_lloc = true;
 			break;
+		    case OPT_NO_YYSET_BUFFER_POLICY:
+			ctrl.no_yyset_buffer_policy = true;
+			break;
 		    case OPT_NO_YYGET_DEBUG:
 			ctrl.no_get_debug = true;
 			break;
@@ -1168,17 +1455,22 @@ void flexinit (int argc, char **argv)
 
 	num_input_files = argc - optind;/*有多少个输入文件*/
 	input_files = argv + optind;/*指向首个输入文件*/
+	if (env.jobs > 0 && num_input_files > 1)
+		run_jobs (argv, optind);
+	if (env.cache_dir)
+		cache_lookup (argv, optind);
 	/*设置首个输入文件*/
 	set_input_file (num_input_files > 0 ? input_files[0] : NULL);
 
 	lastccl = lastsc = lastdfa = lastnfa = 0;
-	num_rules = num_eof_rules = default_rule = 0;
+	num_rules = num_eof_rules = default_rule = num_skip_rules = 0;
+	num_chunked_rules = 0;
 	numas = numsnpairs = tmpuses = 0;
 	numecs = numeps = eps2 = num_reallocs = hshcol = dfaeql = totnst =
 	    0;
 	numuniq = numdup = hshsave = eofseen = datapos = dataline = 0;
 	num_backing_up = onesp = numprots = 0;
-	variable_trailing_context_rules = bol_needed = false;
+	variable_trailing_context_rules = trail_tags = bol_needed = false;
 
 	linenum = sectnum = 1;
 	firstprot = NIL;
@@ -1197,6 +1489,7 @@ void flexinit (int argc, char **argv)
 void readin (void)
 {
 	char buf[256];
+	int i;
 
 	line_directive_out(NULL, infilename/*输入文件*/, linenum/*行号*/);
 
@@ -1231,19 +1524,17 @@ void readin (void)
 	if (tablesext) {
 		FILE   *tablesout;
 		struct yytbl_hdr hdr;
-		char   *pname = 0;
 		size_t  nbytes = 0;
 
+		/* The name is kept for cache_outputs(). */
 		if (!tablesfilename) {
 			nbytes = strlen (ctrl.prefix) + strlen (tablesfile_template) + 2;
-			tablesfilename = pname = calloc(nbytes, 1);
-			snprintf (pname, nbytes, tablesfile_template, ctrl.prefix);
+			tablesfilename = calloc(nbytes, 1);
+			snprintf (tablesfilename, nbytes, tablesfile_template, ctrl.prefix);
 		}
 
 		if ((tablesout = fopen (tablesfilename, "w")) == NULL)
 			lerr (_("could not create %s"), tablesfilename);
-		free(pname);
-		tablesfilename = 0;
 
 		yytbl_writer_init (&tableswr, tablesout);
 
@@ -1345,6 +1636,17 @@ void readin (void)
 	else if (ctrl.reject_really_used == false)
 		reject = false;
 
+	/* Variable trailing context is matched with position tags, unless
+	 * the scanner needs the REJECT machinery anyway or has a match loop
+	 * the tags are not kept in; then it uses that.
+	 */
+	if (variable_trailing_context_rules)
+		trail_tags = !reject && is_default_backend()
+			&& !ctrl.fullspd && !tablesext
+			&& !ctrl.lazy_dfa && !ctrl.shuffle_dfa && ctrl.stride == 1
+			&& !ctrl.parallel && !ctrl.interleave && !ctrl.token_batch
+			&& !ctrl.shared_runtime && !ctrl.relex;
+
 	if (env.performance_hint > 0) {
 		if (ctrl.lex_compat) {
 			fprintf (stderr,
@@ -1378,7 +1680,7 @@ void readin (void)
 				 _
 				 ("REJECT entails a large performance penalty\n"));
 
-		if (variable_trailing_context_rules)
+		if (variable_trailing_context_rules && !trail_tags)
 			fprintf (stderr,
 				 _
 				 ("Variable trailing context rules entail a large performance penalty\n"));
@@ -1387,7 +1689,7 @@ void readin (void)
 	if (reject)
 		real_reject = true;
 
-	if (variable_trailing_context_rules)
+	if (variable_trailing_context_rules && !trail_tags)
 		reject = true;
 
 	if ((ctrl.fulltbl || ctrl.fullspd) && reject) {
@@ -1402,6 +1704,276 @@ void readin (void)
 				   ("variable trailing context rules cannot be used with -f or -F"));
 	}
 
+	if (ctrl.bulk_input && (ctrl.C_plus_plus || !is_default_backend()))
+		flexerror (_
+			   ("%option bulk-input is only supported by the C scanner"));
+
+	if (ctrl.echo_spans) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option echo-spans is only supported by the C scanner"));
+		else if (ctrl.yytext_is_array)
+			flexerror (_("%option echo-spans cannot be used with %array"));
+		else if (ctrl.parallel)
+			flexerror (_
+				   ("%option echo-spans cannot be used with %option parallel"));
+		else if (ctrl.interleave)
+			flexerror (_
+				   ("%option echo-spans cannot be used with %option interleave"));
+		else if (ctrl.token_batch)
+			flexerror (_
+				   ("%option echo-spans cannot be used with %option token-batch"));
+	}
+
+	if (ctrl.catch_backup) {
+		if (!is_default_backend())
+			flexerror (_
+				   ("%option catch-backup is only supported by the C and C++ scanners"));
+		else if (!ctrl.fulltbl && !ctrl.fullspd)
+			flexerror (_
+				   ("%option catch-backup needs -Cf or -CF; compressed tables always back up"));
+	}
+
+	if (ctrl.parallel) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option parallel is only supported by the C scanner"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option parallel"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %option parallel"));
+	}
+
+	if (ctrl.interleave) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option interleave is only supported by the C scanner"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option interleave"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %option interleave"));
+	}
+
+	if (ctrl.relex) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option relex is only supported by the C scanner"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option relex"));
+		else if (yymore_used)
+			flexerror (_
+				   ("yymore() cannot be used with %option relex"));
+	}
+
+	if (ctrl.shared_runtime) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option shared-runtime is only supported by the C scanner"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option shared-runtime"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %option shared-runtime"));
+		else if (ctrl.relex)
+			flexerror (_
+				   ("%option relex cannot be used with %option shared-runtime"));
+	}
+
+	if (ctrl.thread_local) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option thread-local is only supported by the C scanner"));
+		else if (ctrl.reentrant)
+			flexerror (_
+				   ("%option thread-local cannot be used with %option reentrant"));
+		else if (ctrl.shared_runtime)
+			flexerror (_
+				   ("%option shared-runtime cannot be used with %option thread-local"));
+		else if (tablesext)
+			flexerror (_
+				   ("%option thread-local cannot be used with --tables-file"));
+	}
+
+	if (tablesembed) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("--embed-tables is only supported by the C scanner"));
+		else if (tablesverify)
+			flexerror (_
+				   ("--embed-tables cannot be used with --tables-verify"));
+		else if (strpbrk (tablesfilename, "\"\\[]\n"))
+			flexerror (_
+				   ("the --embed-tables file name cannot contain quotes, backslashes or brackets"));
+	}
+
+	/* Scanners cannot load the trailing-context table. */
+	if (tablestrail && (!tablesext || tablesembed || tablesverify))
+		flexerror (_
+			   ("--tables-trail needs --tables-file, and cannot be used with --embed-tables or --tables-verify"));
+
+	if (ctrl.token_batch) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option token-batch is only supported by the C scanner"));
+		else if (ctrl.bison_bridge_lval)
+			flexerror (_
+				   ("%option token-batch cannot be used with %option bison-bridge"));
+		else if (ctrl.yytext_is_array)
+			flexerror (_
+				   ("%option token-batch cannot be used with %array"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option token-batch"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %option token-batch"));
+	}
+
+	if (ctrl.lazy_dfa) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%option lazy-dfa is only supported by the C scanner"));
+		else if (ctrl.fulltbl || ctrl.fullspd)
+			flexerror (_
+				   ("%option lazy-dfa cannot be used with -f or -F"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option lazy-dfa"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %option lazy-dfa"));
+		else if (ctrl.parallel)
+			flexerror (_
+				   ("%option lazy-dfa cannot be used with %option parallel"));
+		else if (ctrl.interleave)
+			flexerror (_
+				   ("%option lazy-dfa cannot be used with %option interleave"));
+		else if (tablesext)
+			flexerror (_
+				   ("%option lazy-dfa cannot be used with --tables-file"));
+		else if (env.backing_up_report)
+			flexerror (_
+				   ("-b cannot be used with %option lazy-dfa"));
+
+		/* There are no templates to index. */
+		ctrl.usemecs = false;
+	}
+
+	if (ctrl.shuffle_dfa) {
+		if (!is_default_backend())
+			flexerror (_
+				   ("%option shuffle-dfa is only supported by the C and C++ scanners"));
+		else if (ctrl.fulltbl || ctrl.fullspd)
+			flexerror (_
+				   ("%option shuffle-dfa cannot be used with -f or -F"));
+		else if (real_reject)
+			flexerror (_
+				   ("REJECT cannot be used with %option shuffle-dfa"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %option shuffle-dfa"));
+		else if (ctrl.lazy_dfa)
+			flexerror (_
+				   ("%option shuffle-dfa cannot be used with %option lazy-dfa"));
+		else if (tablesext)
+			flexerror (_
+				   ("%option shuffle-dfa cannot be used with --tables-file"));
+	}
+
+	if (ctrl.stride != 1) {
+		if (ctrl.stride != 2)
+			flexerror (_("the stride must be 1 or 2"));
+		else if (!is_default_backend())
+			flexerror (_
+				   ("-Cs2 is only supported by the C and C++ scanners"));
+		else if (ctrl.fullspd)
+			flexerror (_("-Cs2 cannot be used with -F"));
+		else if (real_reject)
+			flexerror (_("REJECT cannot be used with -Cs2"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with -Cs2"));
+		else if (ctrl.lazy_dfa)
+			flexerror (_("-Cs2 cannot be used with %option lazy-dfa"));
+		else if (ctrl.shuffle_dfa)
+			flexerror (_("-Cs2 cannot be used with %option shuffle-dfa"));
+		else if (tablesext)
+			flexerror (_("-Cs2 cannot be used with --tables-file"));
+	}
+
+	if (ctrl.hybrid) {
+		if (!is_default_backend())
+			flexerror (_
+				   ("-Ch is only supported by the C and C++ scanners"));
+		else if (ctrl.fulltbl || ctrl.fullspd)
+			flexerror (_("-Ch cannot be used with -Cf or -CF"));
+		else if (ctrl.lazy_dfa)
+			flexerror (_("-Ch cannot be used with %option lazy-dfa"));
+		else if (tablesext)
+			flexerror (_("-Ch cannot be used with --tables-file"));
+	}
+
+	/* A %chunked token is cut where yy_get_previous_state() can take
+	 * it up again, which only the compressed tables' match loop does.
+	 */
+	if (num_chunked_rules > 0) {
+		if (ctrl.C_plus_plus || !is_default_backend())
+			flexerror (_
+				   ("%chunked is only supported by the C scanner"));
+		else if (ctrl.fulltbl || ctrl.fullspd)
+			flexerror (_("%chunked cannot be used with -f or -F"));
+		else if (real_reject)
+			flexerror (_("REJECT cannot be used with %chunked"));
+		else if (reject)
+			flexerror (_
+				   ("variable trailing context rules cannot be used with %chunked"));
+		else if (yymore_used)
+			flexerror (_("yymore() cannot be used with %chunked"));
+		else if (ctrl.lazy_dfa)
+			flexerror (_
+				   ("%chunked cannot be used with %option lazy-dfa"));
+		else if (ctrl.shuffle_dfa)
+			flexerror (_
+				   ("%chunked cannot be used with %option shuffle-dfa"));
+		else if (ctrl.stride != 1)
+			flexerror (_("%chunked cannot be used with -Cs2"));
+		else if (ctrl.parallel)
+			flexerror (_
+				   ("%chunked cannot be used with %option parallel"));
+		else if (ctrl.interleave)
+			flexerror (_
+				   ("%chunked cannot be used with %option interleave"));
+		else if (ctrl.token_batch)
+			flexerror (_
+				   ("%chunked cannot be used with %option token-batch"));
+		else if (ctrl.relex)
+			flexerror (_
+				   ("%chunked cannot be used with %option relex"));
+		else if (ctrl.shared_runtime)
+			flexerror (_
+				   ("%chunked cannot be used with %option shared-runtime"));
+		else if (tablesext)
+			flexerror (_("%chunked cannot be used with --tables-file"));
+	}
+
+	/* Skip rules are matched without running anything per rule, so
+	 * don't fuse them when something has to run for every match.
+	 */
+	if (reject || yymore_used || ctrl.ddebug || ctrl.preaction != NULL
+	    || ctrl.postaction != NULL)
+		num_skip_rules = 0;
+
+	/* Nor let what runs around each action see ECHOs still queued. */
+	if (ctrl.preaction != NULL || ctrl.postaction != NULL)
+		for (i = 1; i <= num_rules; ++i)
+			rule_echo[i] = false;
+
 	if (ctrl.useecs)
 		numecs = cre8ecs (nextecm, ecgroup, ctrl.csize);
 	else
@@ -1500,11 +2072,15 @@ void readin (void)
 		visible_define ( "M4_MODE_NO_CPP_USE_READ");
 
 	// mode switches for next-action code
-	if (variable_trailing_context_rules) {
+	if (variable_trailing_context_rules && !trail_tags) {
 		visible_define ( "M4_MODE_VARIABLE_TRAILING_CONTEXT_RULES");
 	} else {
 		visible_define ( "M4_MODE_NO_VARIABLE_TRAILING_CONTEXT_RULES");
 	}
+	if (trail_tags)
+		visible_define ( "M4_MODE_TRAIL_TAGS");
+	if (num_chunked_rules > 0)
+		visible_define ( "M4_MODE_CHUNKED");
 	if (real_reject)
 		visible_define ( "M4_MODE_REAL_REJECT");
 	if (ctrl.reject_really_used)
@@ -1592,6 +2168,8 @@ void readin (void)
 
 	if (tablesext)
 		visible_define ( "M4_MODE_TABLESEXT");
+	if (tablesembed)
+		visible_define_str ( "M4_MODE_EMBED_TABLES", tablesfilename);
 	if (ctrl.prefix != NULL)
 	    visible_define_str ( "M4_MODE_PREFIX", ctrl.prefix);
 
@@ -1652,6 +2230,8 @@ void readin (void)
 		visible_define("M4_YY_NO_GET_LLOC");
 	if (ctrl.no_yyset_lloc)
 		visible_define("M4_YY_NO_SET_LLOC");
+	if (ctrl.no_yyset_buffer_policy)
+		visible_define("M4_YY_NO_SET_BUFFER_POLICY");
 	if (ctrl.no_flex_alloc)
 		visible_define("M4_YY_NO_FLEX_ALLOC");
 	if (ctrl.no_flex_realloc)
@@ -1672,6 +2252,30 @@ void readin (void)
 		visible_define("M4_YY_NEVER_INTERACTIVE");
 	if (ctrl.stack_used)
 		visible_define("M4_YY_STACK_USED");
+	if (ctrl.parallel)
+		visible_define("M4_MODE_PARALLEL");
+	if (ctrl.interleave)
+		visible_define("M4_MODE_INTERLEAVE");
+	if (ctrl.catch_backup)
+		visible_define("M4_MODE_CATCH_BACKUP");
+	if (ctrl.bulk_input)
+		visible_define("M4_MODE_BULK_INPUT");
+	if (ctrl.echo_spans)
+		visible_define("M4_MODE_ECHO_SPANS");
+	if (ctrl.relex)
+		visible_define("M4_MODE_RELEX");
+	if (ctrl.shared_runtime)
+		visible_define("M4_MODE_SHARED_RUNTIME");
+	else
+		visible_define("M4_MODE_NO_SHARED_RUNTIME");
+	if (ctrl.thread_local)
+		visible_define("M4_MODE_THREAD_LOCAL");
+	if (ctrl.token_batch)
+		visible_define("M4_MODE_TOKEN_BATCH");
+	if (ctrl.lazy_dfa)
+		visible_define("M4_MODE_LAZY_DFA");
+	if (num_skip_rules > 0)
+		visible_define("M4_MODE_SKIP_RULES");
 
 	if (ctrl.rewrite)
 		visible_define ( "M4_MODE_REWRITE");
@@ -1703,7 +2307,11 @@ void set_up_initial_allocations (void)
 	rule_type = allocate_integer_array (current_max_rules);
 	rule_linenum = allocate_integer_array (current_max_rules);
 	rule_useful = allocate_integer_array (current_max_rules);
+	rule_trail = allocate_integer_array (current_max_rules);
 	rule_has_nl = allocate_bool_array (current_max_rules);
+	rule_skip = allocate_bool_array (current_max_rules);
+	rule_chunked = allocate_bool_array (current_max_rules);
+	rule_echo = allocate_bool_array (current_max_rules);
 
 	current_max_scs = INITIAL_MAX_SCS;
 	scset = allocate_integer_array (current_max_scs);
@@ -1740,6 +2348,9 @@ void set_up_initial_allocations (void)
 	dfaacc = allocate_dfaacc_union (current_max_dfas);
 
 	nultrans = NULL;
+	dfa_nxt = NULL;
+	dense_row = NULL;
+	num_dense_rows = 0;
 }
 
 
@@ -1762,11 +2373,16 @@ void usage (void)
 		  "  -Ce, --ecs        construct equivalence classes\n"
 		  "  -Cf               do not compress tables; use -f representation\n"
 		  "  -CF               do not compress tables; use -F representation\n"
+		  "  -Ch               give hot DFA states dense rows in the compressed tables\n"
 		  "  -Cm, --meta-ecs   construct meta-equivalence classes\n"
 		  "  -Cr, --read       use read() instead of stdio for scanner input\n"
+		  "  -Cs2              step the DFA over two input bytes at a time\n"
 		  "  -f, --full        generate fast, large scanner. Same as -Cfr\n"
 		  "  -F, --fast        use alternate table representation. Same as -CFr\n"
 		  "  -Cem              default compression (same as --ecs --meta-ecs)\n"
+		  "      --lazy-dfa    build DFA states while scanning instead of in flex\n"
+		  "      --shuffle-dfa run DFAs of up to 15 states on byte-shuffle tables\n"
+		  "      --catch-backup with -Cf or -CF, keep no backing-up info while matching\n"
 		  "\n" "Debugging:\n"
 		  "  -d, --debug             enable debug mode in scanner\n"
 		  "  -b, --backup            write backing-up information to %s\n"
@@ -1778,12 +2394,16 @@ void usage (void)
 		  "      --hex               use hexadecimal numbers instead of octal in debug outputs\n"
 		  "\n" "Files:\n"
 		  "  -o, --outfile=FILE      specify output filename\n"
+		  "  -j, --jobs=N            generate FILE.c, not lex.PREFIX.c, for each FILE, N at a time\n"
 		  "  -S, --skel=FILE         specify skeleton file\n"
 		  "  -t, --stdout            write scanner on stdout instead of %s\n"
 		  "      --yyclass=NAME      name of C++ class\n"
 		  "      --header-file=FILE   create a C header file in addition to the scanner\n"
 		  "      --tables-file[=FILE] write tables to FILE\n"
-		  "      --backup-file=FILE  write backing-up information to FILE\n" "\n"
+		  "      --embed-tables[=FILE] write tables to FILE and build them into the scanner\n"
+		  "      --tables-trail      add the rules' trailing context to the tables file\n"
+		  "      --backup-file=FILE  write backing-up information to FILE\n"
+		  "      --cache-dir=DIR     reuse scanners generated before from the same input\n" "\n"
 		  "Scanner behavior:\n"
 		  "  -7, --7bit              generate 7-bit scanner\n"
 		  "  -8, --8bit              generate 8-bit scanner\n"
@@ -1800,6 +2420,13 @@ void usage (void)
 		  "  -L,  --noline            suppress #line directives in scanner\n"
 		  "  -P,  --prefix=STRING     use STRING as prefix instead of \"yy\"\n"
 		  "  -R,  --reentrant         generate a reentrant scanner\n"
+		  "       --parallel          generate yylex_parallel() for multi-threaded scanning\n"
+		  "       --interleave        generate yylex_interleaved() to scan many inputs at once\n"
+		  "       --relex             generate yy_relex() to re-scan edited input incrementally\n"
+		  "       --shared-runtime    leave input buffer management to libflexrt\n"
+		  "       --thread-local      give each thread its own non-reentrant scanner state\n"
+		  "       --token-batch       generate yylex_batch() to fetch many tokens per call\n"
+		  "       --echo-spans        write consecutive ECHOs with one call\n"
 		  "       --bison-bridge      scanner for Bison pure parser.\n"
 		  "       --bison-locations   include yylloc support.\n"
 		  "       --stdinit           initialize yyin/yyout to stdin/stdout\n"
@@ -39,6 +39,12 @@
 int	dupmachine(int);
 void	mkxtion(int, int);
 
+/* The rules sharing the action being scanned, and where its text starts
+ * in action_array; see finish_action().
+ */
+static int action_first_rule, action_last_rule, action_eof_rules;
+static int action_start;
+
 
 /* add_accept - add an accepting state to a machine
  *
@@ -209,6 +215,10 @@ void    finish_rule (int mach, int variable_trail_rule, int headcnt, int trailcn
 	if (continued_action)
 		--rule_linenum[num_rules];
 
+	if (rule_chunked[num_rules]
+	    && (variable_trail_rule || headcnt > 0 || trailcnt > 0))
+		synerr (_("%chunked rules cannot have trailing context"));
+
 
 	/* If the previous rule was continued action, then we inherit the
 	 * previous newline flag, possibly overriding the current one.
@@ -216,6 +226,9 @@ void    finish_rule (int mach, int variable_trail_rule, int headcnt, int trailcn
 	if (pcont_act && rule_has_nl[num_rules - 1])
 		rule_has_nl[num_rules] = true;
 
+	if (!pcont_act)
+		action_first_rule = num_rules;
+
 	snprintf (action_text, sizeof(action_text), "M4_HOOK_NORMAL_STATE_CASE_ARM(%d)\n", num_rules);
 	add_action (action_text);
 	if (rule_has_nl[num_rules]) {
@@ -235,6 +248,13 @@ void    finish_rule (int mach, int variable_trail_rule, int headcnt, int trailcn
 				 rule_linenum[num_rules]);
 
 		variable_trailing_context_rules = true;
+
+		/* If the scanner finds the end of the head with position
+		 * tags rather than REJECT, give the rest back here.
+		 */
+		snprintf (action_text, sizeof(action_text), "M4_HOOK_TRAIL_SPLIT(%d)\n",
+			 rule_has_nl[num_rules] ? 1 : 0);
+		add_action (action_text);
 	}
 
 	else {
@@ -246,6 +266,11 @@ void    finish_rule (int mach, int variable_trail_rule, int headcnt, int trailcn
 			 */
 			add_action ("M4_HOOK_RELEASE_YYTEXT\n");
 
+			/* Record the adjustment for drivers that only
+			 * see the tables, e.g. yylex_parallel().
+			 */
+			rule_trail[num_rules] = headcnt > 0 ? headcnt : -trailcnt;
+
 			if (headcnt > 0) {
 				if (rule_has_nl[num_rules]) {
 					snprintf (action_text, sizeof(action_text),
@@ -284,6 +309,71 @@ void    finish_rule (int mach, int variable_trail_rule, int headcnt, int trailcn
 
 	line_directive_out(NULL, infilename, linenum);
         add_action("[[");
+
+	action_last_rule = num_rules;
+	action_eof_rules = num_eof_rules;
+	action_start = action_index;
+}
+
+
+/* finish_action - finish up the action just scanned
+ *
+ * If it is the action of a rule, rather than of an <<EOF>>, and does
+ * nothing at all, the rule and any rules continued into it with "|" are
+ * marked as skip rules.  Rules with trailing context are never marked,
+ * since their actions have to give the trailing context back.
+ *
+ * If instead the action does nothing but yyecho() (or ECHO), the rules
+ * are marked as echo rules.
+ */
+
+void    finish_action (void)
+{
+	int     i;
+	bool    empty = true, echo = false;
+
+	if (action_last_rule != num_rules || action_eof_rules != num_eof_rules)
+		return;
+
+	for (i = action_start; i < action_index && empty; ++i) {
+		char    c = action_array[i];
+
+		if (c == '/' && action_array[i + 1] == '*') {
+			char   *end = strstr (&action_array[i + 2], "*/");
+
+			if (end == NULL || end - action_array + 2 > action_index)
+				empty = false;
+			else
+				i = (int) (end - action_array) + 1;
+		}
+		else if (!echo && (!strncmp (&action_array[i], "yyecho();", 9)
+				   || !strncmp (&action_array[i], "ECHO;", 5))) {
+			echo = true;
+			i += c == 'y' ? 8 : 4;
+		}
+		else if (!isspace ((unsigned char) c) && c != ';' && c != '{'
+			 && c != '}')
+			empty = false;
+	}
+
+	if (empty && echo) {
+		for (i = action_first_rule; i <= action_last_rule; ++i)
+			rule_echo[i] = true;
+		empty = false;
+	}
+
+	for (i = action_first_rule; i <= action_last_rule; ++i)
+		if (rule_type[i] != RULE_NORMAL || rule_trail[i] != 0
+		    || rule_chunked[i])
+			empty = false;
+
+	if (empty)
+		for (i = action_first_rule; i <= action_last_rule; ++i) {
+			rule_skip[i] = true;
+			++num_skip_rules;
+		}
+
+	action_last_rule = 0;
 }
 
 
@@ -689,8 +779,16 @@ void    new_rule (void)
 							 current_max_rules);
 		rule_useful = reallocate_integer_array (rule_useful,
 							current_max_rules);
+		rule_trail = reallocate_integer_array (rule_trail,
+						       current_max_rules);
 		rule_has_nl = reallocate_bool_array (rule_has_nl,
 						     current_max_rules);
+		rule_skip = reallocate_bool_array (rule_skip,
+						   current_max_rules);
+		rule_chunked = reallocate_bool_array (rule_chunked,
+						      current_max_rules);
+		rule_echo = reallocate_bool_array (rule_echo,
+						   current_max_rules);
 	}
 
 	if (num_rules > MAX_RULE)
@@ -698,5 +796,14 @@ void    new_rule (void)
 
 	rule_linenum[num_rules] = linenum;
 	rule_useful[num_rules] = false;
+	rule_trail[num_rules] = 0;
 	rule_has_nl[num_rules] = false;
+	rule_skip[num_rules] = false;
+	rule_echo[num_rules] = false;
+
+	/* The scanner has already seen a %chunked in front of the rule. */
+	rule_chunked[num_rules] = chunked_rule;
+	if (chunked_rule)
+		++num_chunked_rules;
+	chunked_rule = false;
 }
@@ -64,6 +64,8 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,			/* Generate backing-up information to lex.backup. */
 	{"--backup-file=FILE", OPT_BACKUP_FILE, 0}
 	,			/* Generate backing-up information to FILE. */
+	{"--cache-dir=DIR", OPT_CACHE_DIR, 0}
+	,			/* Reuse scanners generated before. */
 	{"-B", OPT_BATCH, 0}
 	,
 	{"--batch", OPT_BATCH, 0}
@@ -72,12 +74,16 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,			/* Scanner to be called by a bison pure parser. */
 	{"--bison-locations", OPT_BISON_BRIDGE_LOCATIONS, 0}
 	,			/* Scanner to be called by a bison pure parser. */
+	{"--bulk-input", OPT_BULK_INPUT, 0}
+	,			/* Generate yyinput_bulk(), yyskip() and yypeek(). */
 	{"-i", OPT_CASE_INSENSITIVE, 0}
 	,
 	{"--case-insensitive", OPT_CASE_INSENSITIVE, 0}
 	,			/* Generate case-insensitive scanner. */
+	{"--catch-backup", OPT_CATCH_BACKUP, 0}
+	,			/* Keep no backing-up information while matching. */
 	
-		{"-C[aefFmr]", OPT_COMPRESSION,
+		{"-C[aefFhmrs]", OPT_COMPRESSION,
 	 "Specify degree of table compression (default is -Cem)"},
 	{"-+", OPT_CPLUSPLUS, 0}
 	,
@@ -99,8 +105,12 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,			/* For POSIX lex compatibility. */
 	{"-n", OPT_DONOTHING, 0}
 	,			/* For POSIX lex compatibility. */
+	{"--echo-spans", OPT_ECHO_SPANS, 0}
+	,			/* Write consecutive ECHOs with one call. */
 	{"--ecs", OPT_ECS, 0}
 	,
+	{"--embed-tables[=FILE]", OPT_EMBED_TABLES, 0}
+	,			/* Save tables to FILE and build them into the scanner. */
 	{"--emit=LANG", OPT_EMIT, 0}
 	,			/* select language to emit */
 	{"-e LANG", OPT_EMIT, 0}
@@ -129,6 +139,14 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,
 	{"--interactive", OPT_INTERACTIVE, 0}
 	,			/* Generate interactive scanner (opposite of -B). */
+	{"--interleave", OPT_INTERLEAVE, 0}
+	,			/* Generate yylex_interleaved(). */
+	{"-j N", OPT_JOBS, 0}
+	,
+	{"--jobs=N", OPT_JOBS, 0}
+	,			/* One scanner per input file, N at a time. */
+	{"--lazy-dfa", OPT_LAZY_DFA, 0}
+	,			/* Build DFA states at run time. */
 	{"-l", OPT_LEX_COMPAT, 0}
 	,
 	{"--lex-compat", OPT_LEX_COMPAT, 0}
@@ -157,6 +175,8 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,
 	{"--outfile=FILE", OPT_OUTFILE, 0}
 	,			/* Write to FILE (default is lex.yy.c) */
+	{"--parallel", OPT_PARALLEL, 0}
+	,			/* Generate the speculative parallel scanner. */
 	{"-p", OPT_PERF_REPORT, 0}
 	,
 	{"--perf-report", OPT_PERF_REPORT, 0}
@@ -177,10 +197,16 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,			/* Generate a reentrant C scanner. */
 	{"--noreentrant", OPT_NO_REENTRANT, 0}
 	,
+	{"--relex", OPT_RELEX, 0}
+	,			/* Generate yy_relex() for incremental re-scanning. */
 	{"--reject", OPT_REJECT, 0}
 	,
 	{"--noreject", OPT_NO_REJECT, 0}
 	,
+	{"--shared-runtime", OPT_SHARED_RUNTIME, 0}
+	,			/* Leave buffer management to libflexrt. */
+	{"--shuffle-dfa", OPT_SHUFFLE_DFA, 0}
+	,			/* Run small DFAs on byte-shuffle tables. */
 	{"-S FILE", OPT_SKEL, 0}
 	,
 	{"--skel=FILE", OPT_SKEL, 0}
@@ -203,6 +229,12 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,			/* Save tables to FILE */
         {"--tables-verify", OPT_TABLES_VERIFY, 0}
         ,                       /* Tables integrity check */
+	{"--tables-trail", OPT_TABLES_TRAIL, 0}
+	,			/* Add the trailing context table, for flex_compile(). */
+	{"--thread-local", OPT_THREAD_LOCAL, 0}
+	,			/* Per-thread state for a non-reentrant scanner. */
+	{"--token-batch", OPT_TOKEN_BATCH, 0}
+	,			/* Generate yylex_batch(). */
 	{"--nounistd", OPT_NO_UNISTD_H, 0}
 	,			/* Do not include unistd.h */
 	{"-v", OPT_VERBOSE, 0}
@@ -287,6 +319,8 @@ optspec_t flexopts[] = {/*flex支持的选项*/
 	,
 	{"--noyyset_lloc", OPT_NO_YYSET_LLOC, 0}
 	,
+	{"--noyyset_buffer_policy", OPT_NO_YYSET_BUFFER_POLICY, 0}
+	,
 	{"--noyyget_debug", OPT_NO_YYGET_DEBUG, 0}
 	,
 	{"--noyyset_debug", OPT_NO_YYSET_DEBUG, 0}
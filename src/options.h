@@ -50,13 +50,18 @@ enum flexopt_flag_t {
 	OPT_BATCH,
         OPT_BISON_BRIDGE,
         OPT_BISON_BRIDGE_LOCATIONS,
+	OPT_BULK_INPUT,
+	OPT_CACHE_DIR,
 	OPT_CASE_INSENSITIVE,
+	OPT_CATCH_BACKUP,
 	OPT_COMPRESSION,
 	OPT_CPLUSPLUS,
 	OPT_DEBUG,
 	OPT_DEFAULT,
 	OPT_DONOTHING,
+	OPT_ECHO_SPANS,
 	OPT_ECS,
+	OPT_EMBED_TABLES,
 	OPT_EMIT,
 	OPT_FAST,
 	OPT_FULL,
@@ -64,6 +69,9 @@ enum flexopt_flag_t {
 	OPT_HELP,
 	OPT_HEX,
 	OPT_INTERACTIVE,
+	OPT_INTERLEAVE,
+	OPT_JOBS,
+	OPT_LAZY_DFA,
 	OPT_LEX_COMPAT,
 	OPT_POSIX_COMPAT,
 	OPT_MAIN,
@@ -102,6 +110,7 @@ enum flexopt_flag_t {
 	OPT_NO_YYSET_LVAL,
 	OPT_NO_YYSET_OUT,
 	OPT_NO_YYSET_DEBUG,
+	OPT_NO_YYSET_BUFFER_POLICY,
 	OPT_NO_YYWRAP,
 	OPT_NO_YY_POP_STATE,
 	OPT_NO_YY_PUSH_STATE,
@@ -110,6 +119,7 @@ enum flexopt_flag_t {
 	OPT_NO_YY_SCAN_STRING,
 	OPT_NO_YY_TOP_STATE,
 	OPT_OUTFILE,
+	OPT_PARALLEL,
 	OPT_PERF_REPORT,
 	OPT_POINTER,
 	OPT_PREFIX,
@@ -118,12 +128,18 @@ enum flexopt_flag_t {
 	OPT_READ,
 	OPT_REENTRANT,
 	OPT_REJECT,
+	OPT_RELEX,
+	OPT_SHARED_RUNTIME,
+	OPT_SHUFFLE_DFA,
 	OPT_SKEL,
 	OPT_STACK,
 	OPT_STDINIT,
 	OPT_STDOUT,
 	OPT_TABLES_FILE,
+	OPT_TABLES_TRAIL,
 	OPT_TABLES_VERIFY,
+	OPT_THREAD_LOCAL,
+	OPT_TOKEN_BATCH,
 	OPT_TRACE,
 	OPT_NO_UNISTD_H,
 	OPT_VERBOSE,
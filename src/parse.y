@@ -3,7 +3,7 @@
 %token CHAR NUMBER SECTEND SCDECL XSCDECL NAME PREVCCL EOF_OP
 %token TOK_OPTION TOK_OUTFILE TOK_PREFIX TOK_YYCLASS TOK_HEADER_FILE TOK_EXTRA_TYPE
 %token TOK_TABLES_FILE TOK_YYLMAX TOK_NUMERIC TOK_YYDECL TOK_PREACTION TOK_POSTACTION
-%token TOK_USERINIT TOK_EMIT TOK_BUFSIZE TOK_YYTERMINATE
+%token TOK_USERINIT TOK_EMIT TOK_BUFSIZE TOK_YYTERMINATE TOK_STRIDE
 
 %token CCE_ALNUM CCE_ALPHA CCE_BLANK CCE_CNTRL CCE_DIGIT CCE_GRAPH
 %token CCE_LOWER CCE_PRINT CCE_PUNCT CCE_SPACE CCE_UPPER CCE_XDIGIT
@@ -142,6 +142,7 @@ goal		:  initlex sect1 sect1end sect2 initforrule
 				"M4_HOOK_FATAL_ERROR(\"flex scanner jammed\")");
 			else {
 			    add_action("M4_HOOK_ECHO");
+			    rule_echo[default_rule] = true;
 			}
 
 			add_action( "\n\tM4_HOOK_STATE_CASE_BREAK\n" );
@@ -220,6 +221,8 @@ option		:  TOK_OUTFILE '=' NAME
 			{ ctrl.postaction = xstrdup(nmstr); }
 		|  TOK_BUFSIZE '=' TOK_NUMERIC
 			{ ctrl.bufsize = nmval; }
+		|  TOK_STRIDE '=' TOK_NUMERIC
+			{ ctrl.stride = nmval; }
 		|  TOK_EMIT '=' NAME
 			{ ctrl.emit = xstrdup(nmstr); backend_by_name(ctrl.emit); }
 		|  TOK_USERINIT '=' NAME
@@ -312,6 +315,9 @@ flexrule	:  '^' rule
 
 		|  EOF_OP
 			{
+			if ( rule_chunked[num_rules] )
+				synerr( _("<<EOF>> rules cannot be %chunked") );
+
 			if ( scon_stk_ptr > 0 )
 				build_eof_action();
 	
@@ -80,6 +80,19 @@ bool is_default_backend(void)
     return backend == &backends[0];
 }
 
+/* Pass each line of each built-in skeleton to fn, so that the output
+ * cache can tell one build of flex from another.
+ */
+void skel_walk(void (*fn)(const char *, void *), void *arg)
+{
+	struct flex_backend_t *b;
+	int i;
+
+	for (b = &backends[0]; b->skel != NULL; b++)
+		for (i = 0; b->skel[i] != NULL; i++)
+			fn(b->skel[i], arg);
+}
+
 /* Search for a string in the skeleton prolog, where macros are defined.
  */
 static bool boneseeker(const char *bone)
@@ -57,9 +57,10 @@ struct yytbl_writer {
  * tablesname - name that goes in serialized data, e.g., "yytables"
  * tableswr -  writer for external tables
  * tablesverify - true if tables-verify option specified
+ * tablestrail - true if tables-trail option specified
  * gentables - true if we should spit out the normal C tables
  */
-extern bool tablesext, tablesverify,gentables;
+extern bool tablesext, tablesverify, tablestrail, gentables;
 extern char *tablesfilename, *tablesname;
 extern struct yytbl_writer tableswr;
 
@@ -80,7 +80,21 @@ enum yytbl_id {
 	YYTD_ID_RULE_CAN_MATCH_EOL = 0x09, /**< 1-dim ints */
 	YYTD_ID_START_STATE_LIST = 0x0A,	/**< 1-dim indices into trans tbl  */
 	YYTD_ID_TRANSITION = 0x0B,	/**< structs */
-	YYTD_ID_ACCLIST = 0x0C		/**< 1-dim ints */
+	YYTD_ID_ACCLIST = 0x0C,		/**< 1-dim ints */
+	YYTD_ID_CONSTANTS = 0x0D,	/**< 1-dim ints, indexed by enum yytbl_const */
+	YYTD_ID_RULE_TRAIL = 0x0E	/**< 1-dim ints, written with --tables-trail only */
+};
+
+/** The entries of the YYTD_ID_CONSTANTS table: the scanner's constants
+ *  that depend on its DFA.
+ */
+enum yytbl_const {
+	YYTC_END_OF_BUFFER = 0,		/**< YY_END_OF_BUFFER, one more than the number of rules */
+	YYTC_JAMSTATE = 1,		/**< YY_JAMSTATE */
+	YYTC_JAMBASE = 2,		/**< YY_JAMBASE */
+	YYTC_NUL_EC = 3,		/**< YY_NUL_EC */
+	YYTC_START_CONDITIONS = 4,	/**< number of start conditions */
+	YYTC_SIZE = 5
 };
 
 /** bit flags for t_flags field of struct yytbl_data */
@@ -708,8 +708,9 @@ void    mktemplate (int state[], int statenum, int comstate)
 			tnxt[tmpbase + i] = comstate;
 		}
 
+	/* Without -Ce, class 256 is stored above as 0. */
 	if (ctrl.usemecs)
-		mkeccl (transset, tsptr, tecfwd, tecbck, numecs, 0);
+		mkeccl (transset, tsptr, tecfwd, tecbck, numecs, numecs);
 
 	mkprot (tnxt + tmpbase, -numtemps, comstate);
 
@@ -0,0 +1,193 @@
+/*
+ * This file is part of flex.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * Neither the name of the University nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE.
+ */
+
+%{
+/* Feeds the input to a scanner a few bytes at a time from an awaitable,
+ * as a network connection would, and checks that tokens_async() finds
+ * the tokens that tokens() finds in the whole input at once.
+ */
+#include <coroutine>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "config.h"
+%}
+
+%option 8bit prefix="test"
+%option warn c++ yylineno
+%option nounput nomain noinput noyywrap
+
+%x COMMENT
+
+%%
+
+^"#".*                          { return 1; }
+[[:alpha:]]+"\\"\n              { yymore(); }
+[[:alpha:]]+                    { return 2; }
+[[:digit:]]+("."[[:digit:]]+)?  { return 3; }
+\"([^"\\\n]|\\.)*\"             { return 4; }
+"/*"                            { BEGIN(COMMENT); yymore(); }
+<COMMENT>[^*]+|"*"              { yymore(); }
+<COMMENT>"*/"                   { BEGIN(INITIAL); return 5; }
+[[:space:]]+                    { return 6; }
+.                               { return 7; }
+
+%%
+
+struct tok {
+    int code;
+    std::string text;
+    int lineno;
+
+    bool operator== (const tok &o) const
+    {
+        return code == o.code && text == o.text && lineno == o.lineno;
+    }
+};
+
+/* A connection that delivers the input in pieces of 0 to 7 bytes, one
+ * piece each time the event loop in main() gets to it.
+ */
+struct connection {
+    std::string data;
+    size_t sent = 0;
+    std::string received;
+    std::coroutine_handle<> reader;
+    unsigned seed = 1;
+
+    void deliver ()
+    {
+        seed = seed * 1103515245 + 12345;
+        size_t n = (seed >> 16) % 8;
+
+        if (n > data.size () - sent)
+            n = data.size () - sent;
+        received.append (data, sent, n);
+        sent += n;
+    }
+};
+
+class connection_lexer : public yyFlexLexer {
+public:
+    explicit connection_lexer (connection &c) : conn (c) { }
+
+protected:
+    int LexerInput (char *buf, int max_size) override
+    {
+        if (conn.received.empty ())
+            return conn.sent == conn.data.size () ? 0 : YY_INPUT_PENDING;
+
+        size_t n = conn.received.copy (buf, (size_t) max_size);
+        conn.received.erase (0, n);
+        return (int) n;
+    }
+
+private:
+    connection &conn;
+};
+
+struct wait_for_input {
+    connection *conn;
+
+    bool await_ready () const noexcept { return false; }
+    void await_suspend (std::coroutine_handle<> h) noexcept { conn->reader = h; }
+    void await_resume () const noexcept { }
+};
+
+struct wait_for_more {
+    connection *conn;
+
+    wait_for_input operator() () const { return wait_for_input {conn}; }
+};
+
+struct task {
+    struct promise_type {
+        task get_return_object () { return {}; }
+        std::suspend_never initial_suspend () noexcept { return {}; }
+        std::suspend_never final_suspend () noexcept { return {}; }
+        void return_void () { }
+        void unhandled_exception () { std::terminate (); }
+    };
+};
+
+static task read_tokens (connection &conn, std::vector<tok> &out, bool &done)
+{
+    connection_lexer lexer (conn);
+    FlexAsyncTokens toks = lexer.tokens_async (wait_for_more {&conn});
+
+    while (int code = co_await toks.next ())
+        out.push_back (tok {code, lexer.YYText (), lexer.lineno ()});
+    done = true;
+}
+
+int main (void);
+
+int main (void)
+{
+    std::ostringstream all;
+    std::vector<tok> expected;
+
+    all << std::cin.rdbuf ();
+
+    std::istringstream in (all.str ());
+    yyFlexLexer whole (&in);
+    for (int code : whole.tokens ())
+        expected.push_back (tok {code, whole.YYText (), whole.lineno ()});
+    if (expected.size () < 100) {
+        std::cerr << "only " << expected.size () << " tokens" << std::endl;
+        return 1;
+    }
+
+    for (unsigned seed = 1; seed <= 50; ++seed) {
+        connection conn;
+        std::vector<tok> got;
+        bool done = false;
+        int waits = 0;
+
+        conn.data = all.str ();
+        conn.seed = seed;
+        read_tokens (conn, got, done);
+        while (!done) {
+            if (!conn.reader) {
+                std::cerr << "seed " << seed << ": reader is not waiting" << std::endl;
+                return 1;
+            }
+            std::coroutine_handle<> h = conn.reader;
+            conn.reader = nullptr;
+            conn.deliver ();
+            ++waits;
+            h.resume ();
+        }
+        if (got != expected) {
+            std::cerr << "seed " << seed << ": tokens differ" << std::endl;
+            return 1;
+        }
+        if ((size_t) waits <= conn.data.size () / 8) {
+            std::cerr << "seed " << seed << ": only " << waits << " waits" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "TEST RETURNING OK." << std::endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * This file is part of flex.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * Neither the name of the University nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE.
+ */
+
+/* Compiles rules with flex_compile() in each table format the run-time
+ * supports, and checks the tokens flex_dfa_match() finds with them.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libflex.h"
+
+int main (void);
+
+static const char rules[] =
+    "%x STR\n"
+    "%%\n"
+    "if          ;\n"
+    "ab/c+       ;\n"
+    "[a-z]+      ;\n"
+    "[0-9]+/px   ;\n"
+    "^#.*        ;\n"
+    "\\\"        ;\n"
+    "<STR>[^\"]+ ;\n"
+    "<STR>\\\"   ;\n"
+    "[ \\n]+     ;\n"
+    "\\0         ;\n"
+    "\\xe9       ;\n";
+
+static const char text[] = "if iff abcc 12px #x\n#y\n\"s t\"\0\xe9!";
+
+/* Rule and length of each token of text. */
+static const int expect[][2] = {
+    {1, 2}, {9, 1}, {3, 3}, {9, 1}, {2, 2}, {3, 2}, {9, 1}, {4, 2},
+    {3, 2}, {9, 1}, {12, 1}, {3, 1}, {9, 1}, {5, 2}, {9, 1}, {6, 1},
+    {7, 3}, {8, 1}, {10, 1}, {11, 1}, {12, 1}, {0, 0}
+};
+
+static int check (const char *const *options, const char *what)
+{
+    struct flex_dfa *dfa;
+    void *tables;
+    size_t size, pos = 0, leng;
+    char *errors;
+    int i, rule, sc = 0;
+
+    if (flex_compile (rules, options, &tables, &size, &errors) != 0) {
+        fprintf (stderr, "%s: %s", what, errors ? errors : "flex_compile failed\n");
+        return 1;
+    }
+    if ((dfa = flex_dfa_load (tables, size)) == NULL) {
+        fprintf (stderr, "%s: flex_dfa_load failed\n", what);
+        return 1;
+    }
+    free (tables);
+    if (flex_dfa_rules (dfa) != 11 || flex_dfa_start_conditions (dfa) != 2) {
+        fprintf (stderr, "%s: %d rules, %d start conditions\n", what,
+                 flex_dfa_rules (dfa), flex_dfa_start_conditions (dfa));
+        return 1;
+    }
+
+    for (i = 0; ; ++i) {
+        rule = flex_dfa_match (dfa, sc, pos == 0 || text[pos - 1] == '\n',
+                               text + pos, sizeof (text) - 1 - pos, &leng);
+        if (rule != expect[i][0] || (int) leng != expect[i][1]) {
+            fprintf (stderr, "%s: token %d is rule %d length %d, not rule %d length %d\n",
+                     what, i, rule, (int) leng, expect[i][0], expect[i][1]);
+            return 1;
+        }
+        if (rule == 0)
+            break;
+        if (rule == 6)
+            sc = 1;
+        else if (rule == 8)
+            sc = 0;
+        pos += leng;
+    }
+
+    flex_dfa_free (dfa);
+    return 0;
+}
+
+int main (void)
+{
+    static const char *const full[] = { "-Cf", "-8", NULL };
+    static const char *const fulle[] = { "-Cfe", "-8", NULL };
+    static const char *const em[] = { "-Cem", NULL };
+    static const char *const e[] = { "-Ce", NULL };
+    static const char *const none[] = { "-C", NULL };
+    static const char *const seven[] = { "-7", NULL };
+    struct flex_dfa *dfa;
+    void *tables;
+    size_t size, leng;
+    char *errors;
+
+    if (check (NULL, "default") || check (full, "-Cf") || check (fulle, "-Cfe")
+        || check (em, "-Cem") || check (e, "-Ce") || check (none, "-C"))
+        return 1;
+
+    /* A 7-bit scanner has no rule for 8-bit characters. */
+    if (flex_compile ("%%\na ;\n", seven, &tables, &size, NULL) != 0
+        || (dfa = flex_dfa_load (tables, size)) == NULL) {
+        fprintf (stderr, "-7: could not compile\n");
+        return 1;
+    }
+    free (tables);
+    if (flex_dfa_match (dfa, 0, 1, "\xe9", 1, &leng) != -1 || errno != EILSEQ
+        || flex_dfa_match (dfa, 1, 1, "a", 1, &leng) != -1 || errno != EINVAL) {
+        fprintf (stderr, "-7: bad characters or start conditions matched\n");
+        return 1;
+    }
+    flex_dfa_free (dfa);
+
+    /* Errors come back as flex's diagnostics. */
+    if (flex_compile ("%%\n[a-\n", NULL, &tables, &size, &errors) != -1
+        || errors == NULL || strstr (errors, "<stdin>:2") == NULL) {
+        fprintf (stderr, "bad rules: %s", errors ? errors : "no errors\n");
+        return 1;
+    }
+    free (errors);
+    if (flex_compile ("%%\na REJECT;\n", NULL, &tables, &size, &errors) != -1
+        || errors == NULL || strstr (errors, "REJECT") == NULL) {
+        fprintf (stderr, "REJECT: %s", errors ? errors : "no errors\n");
+        return 1;
+    }
+    free (errors);
+    if (flex_dfa_load (rules, sizeof (rules)) != NULL || errno != EINVAL) {
+        fprintf (stderr, "loaded tables that are not\n");
+        return 1;
+    }
+
+    /* A caller that ignores SIGCHLD cannot learn flex's exit status. */
+    signal (SIGCHLD, SIG_IGN);
+    if (check (NULL, "SIGCHLD ignored"))
+        return 1;
+    if (flex_compile ("%%\n[a-\n", NULL, &tables, &size, &errors) != -1
+        || errors == NULL || strstr (errors, "<stdin>:2") == NULL) {
+        fprintf (stderr, "SIGCHLD ignored, bad rules: %s", errors ? errors : "no errors\n");
+        return 1;
+    }
+    free (errors);
+
+    printf ("TEST RETURNING OK.\n");
+    return 0;
+}
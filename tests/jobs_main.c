@@ -0,0 +1,62 @@
+/*
+ * This file is part of flex.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the University nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE.
+ */
+
+/* Links the two scanners that one run of flex -j2 generated from
+ * jobs_1.l and jobs_2.l, and checks that each does its own job.
+ */
+
+#include <stdio.h>
+
+int onelex (void);
+void *one_scan_string (const char *str);
+
+int twolex_init (void **scanner);
+int twolex (void *scanner);
+void *two_scan_string (const char *str, void *scanner);
+int twolex_destroy (void *scanner);
+
+int main (void);
+
+int main (void)
+{
+    static const char text[] = "12 apples and 7 pears cost 300";
+    void *scanner;
+    int words = 0, numbers = 0;
+
+    one_scan_string (text);
+    while (onelex ())
+        ++words;
+
+    twolex_init (&scanner);
+    two_scan_string (text, scanner);
+    while (twolex (scanner))
+        ++numbers;
+    twolex_destroy (scanner);
+
+    if (words != 4 || numbers != 3) {
+        fprintf (stderr, "%d words and %d numbers\n", words, numbers);
+        return 1;
+    }
+    printf ("TEST RETURNING OK.\n");
+    return 0;
+}
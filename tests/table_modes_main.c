@@ -0,0 +1,145 @@
+/*
+ * This file is part of flex.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the University nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE.
+ */
+
+/* Runs the scanner that a table mode made of table_modes.l against
+ * the reference scanner made of the same rules, on the standard input,
+ * and checks that the two find the same tokens.
+ * The test scanner reads the input once from a file, a few bytes at
+ * a time, and once from a buffer of yy_scan_bytes(), which ends just
+ * past the input; the reference has it in one buffer.  Each '@' of
+ * the input is a NUL.  The input is scanned whole, and then cut short
+ * by one byte more each time, so that the end of the input falls
+ * everywhere in a buffer, and on an odd and an even byte.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* How many times the input is cut short. */
+#define NUM_CUTS 32
+
+/* The bufsize of table_modes.l. */
+#define TEST_BUF_SIZE 16
+
+extern char *testtext;
+extern int testleng, testlineno;
+int testlex (void);
+void *test_create_buffer (FILE *file, int size);
+void *test_scan_bytes (const char *bytes, int len);
+void test_switch_to_buffer (void *b);
+void test_delete_buffer (void *b);
+int testlex_destroy (void);
+
+extern char *reftext;
+extern int refleng, reflineno;
+int reflex (void);
+void *ref_scan_bytes (const char *bytes, int len);
+void ref_delete_buffer (void *b);
+int reflex_destroy (void);
+
+static int scan (const char *buf, size_t len, int from_file);
+
+int main (void);
+
+/* scan - compare the two scanners on the first len bytes of buf
+ *
+ * The test scanner reads them from a file if from_file is set.
+ * Returns the number of tokens, or -1 if the scanners disagree.
+ */
+static int scan (const char *buf, size_t len, int from_file)
+{
+    FILE *in = NULL;
+    void *test_buf, *ref_buf;
+    int tok, ref, ntok = 0;
+
+    if (from_file) {
+        if ((in = tmpfile ()) == NULL || fwrite (buf, 1, len, in) != len) {
+            fprintf (stderr, "cannot make the input file\n");
+            exit (1);
+        }
+        rewind (in);
+        test_buf = test_create_buffer (in, TEST_BUF_SIZE);
+        test_switch_to_buffer (test_buf);
+    }
+    else
+        test_buf = test_scan_bytes (buf, (int) len);
+    testlineno = 1;
+    ref_buf = ref_scan_bytes (buf, (int) len);
+    reflineno = 1;
+
+    do {
+        tok = testlex ();
+        ref = reflex ();
+        /* What yytext holds at the end of the input is not defined. */
+        if (tok != ref || (tok != 0 && (testleng != refleng
+            || memcmp (testtext, reftext, (size_t) testleng) != 0))
+            || testlineno != reflineno) {
+            fprintf (stderr, "%lu bytes from a %s, token %d: rule %d, %d chars, line %d; expected rule %d, %d chars, line %d\n",
+                     (unsigned long) len, from_file ? "file" : "string",
+                     ntok, tok, testleng, testlineno, ref, refleng, reflineno);
+            ntok = -1;
+            break;
+        }
+        ++ntok;
+    } while (tok != 0);
+
+    test_delete_buffer (test_buf);
+    ref_delete_buffer (ref_buf);
+    if (in)
+        fclose (in);
+    return ntok;
+}
+
+int main (void)
+{
+    char *buf = NULL, *p;
+    size_t len = 0, n, cut;
+    int ntok;
+
+    do {
+        buf = realloc (buf, len + BUFSIZ);
+        n = fread (buf + len, 1, BUFSIZ, stdin);
+        len += n;
+    } while (n > 0);
+
+    /* NULs in the text take a path of their own. */
+    for (p = buf; (p = memchr (p, '@', (size_t) (buf + len - p))) != NULL; ++p)
+        *p = '\0';
+
+    if ((ntok = scan (buf, len, 1)) < 100) {
+        if (ntok >= 0)
+            fprintf (stderr, "only %d tokens\n", ntok);
+        return 1;
+    }
+    for (cut = 0; cut <= NUM_CUTS && cut < len; ++cut)
+        if ((cut > 0 && scan (buf, len - cut, 1) < 0)
+            || scan (buf, len - cut, 0) < 0)
+            return 1;
+
+    testlex_destroy ();
+    reflex_destroy ();
+    free (buf);
+    printf ("TEST RETURNING OK.\n");
+    return 0;
+}